@@ -764,6 +764,21 @@ TEST(Test_Bigint, LeftShiftAssigment)
     }
 }
 
+TEST(Test_Bigint, LeftShiftMultiWord)
+{
+    bigint_t a("123456789abcdef");
+
+    a <<= 1000;
+
+    bigint_t expect = bigint_t("123456789abcdef") * pow(bigint_t(2), bigint_t(1000));
+    EXPECT_EQ(a, expect);
+
+    a >>= 1000;
+    EXPECT_EQ(a, bigint_t("123456789abcdef"));
+
+    EXPECT_EQ(bigint_t("fedcba9876543210fedcba98") >> 37, bigint_t("7f6e5d4c3b2a190"));
+}
+
 TEST(Test_Bigint, RightShift)
 {
     {
@@ -1243,6 +1258,141 @@ TEST(Test_Bigint, PowMod)
     ModPowTest(666, 777, 777, 666);
     ModPowTest(111111, 3, 9173503, 4051753);
     ModPowTest(4051753, 6111579, 9173503, 111111);
+
+    // 192-bit exponent: sliding window of 4 bits, odd and even moduli
+    ModPowTest(basic_integer<byte>("1f2e3d4c5b6a79881726354453627180"), basic_integer<byte>("fedcba98765432100123456789abcdef0f1e2d3c4b5a6978"),
+               basic_integer<byte>("c6a4a7935bd1e995c6a4a7935bd1e995c6a4a7935bd1e995"), basic_integer<byte>("7909e01cd5ac51e9f793f5c327aaa3386b9bf871be62aa47"));
+    ModPowTest(basic_integer<byte>("1f2e3d4c5b6a79881726354453627180"), basic_integer<byte>("fedcba98765432100123456789abcdef0f1e2d3c4b5a6978"),
+               basic_integer<byte>("c6a4a7935bd1e995c6a4a7935bd1e994"), basic_integer<byte>("0da561916f1d3985795745ea5f51bdf0"));
+}
+
+TEST(Test_Bigint, MontgomeryContext)
+{
+    {
+        const basic_integer<byte> n = {0x8B, 0xF9, 0xFF}; // 9173503
+        const montgomery_context<basic_integer<byte>> ctx(n);
+
+        const basic_integer<byte> a = 111111;
+        const basic_integer<byte> b = 4051753;
+
+        EXPECT_EQ(ctx.from_montgomery(ctx.to_montgomery(a)), a);
+        EXPECT_EQ(ctx.from_montgomery(ctx.multiply(ctx.to_montgomery(a), ctx.to_montgomery(b))), (a * b) % n);
+        EXPECT_EQ(ctx.pow(a, 3), b);
+    }
+
+    {
+        const bigint_t n("d0b750c8554b64c7a9d34d068e020fb52fea1b39c47971a359f0eec5da0437ea3fc94597d8dbff5444f6ce5a3293ac89");
+        const montgomery_context<bigint_t> ctx(n);
+
+        const bigint_t a("2a8e8ee7c1c6f6f63d7f3a5cfe1e49ed1f6b5f16e8e5c8a4b06b57c2d34f1d8e9a0b1c2d3e4f5061728394a5b6c7d8e9");
+        const bigint_t b("1f0e0d0c0b0a09080706050403020100ffeeddccbbaa99887766554433221100");
+
+        EXPECT_EQ(ctx.from_montgomery(ctx.multiply(ctx.to_montgomery(a), ctx.to_montgomery(b))), (a * b) % n);
+        EXPECT_EQ(ctx.from_montgomery(ctx.square(ctx.to_montgomery(a))), (a * a) % n);
+        EXPECT_EQ(a * a, a * (a + 1) - a);
+
+        // single-word exponents against the windowed bigint-exponent path
+        for (uint32_t e : {0u, 1u, 2u, 3u, 17u, 65537u, 0xffffffffu})
+        {
+            EXPECT_EQ(ctx.pow(a, e), ctx.pow(a, bigint_t(e)));
+        }
+        EXPECT_EQ(cry::pow_mod(a, bigint_t(65537), n), ctx.pow(a, bigint_t(65537)));
+    }
+
+    EXPECT_ANY_THROW(montgomery_context<basic_integer<byte>>(basic_integer<byte>(2014)));
+}
+
+TEST(Test_Bigint, BarrettContext)
+{
+    {
+        const basic_integer<byte> n = {0x8B, 0xF9, 0xFE}; // even
+        const barrett_context<basic_integer<byte>> ctx(n);
+
+        for (uint32_t x : {0u, 1u, 9173502u, 9173503u, 4051753u * 3u, 0xffffffffu})
+        {
+            const basic_integer<byte> arg = x;
+
+            EXPECT_EQ(ctx.reduce(arg), arg % n);
+        }
+
+        basic_integer<byte> x = basic_integer<byte>(4051753) * basic_integer<byte>(9000001);
+        x.reduce(ctx);
+        EXPECT_EQ(x, (basic_integer<byte>(4051753) * basic_integer<byte>(9000001)) % n);
+    }
+
+    {
+        const bigint_t n("d0b750c8554b64c7a9d34d068e020fb52fea1b39c47971a359f0eec5da0437ea3fc94597d8dbff5444f6ce5a3293ac89");
+        const barrett_context<bigint_t> ctx(n);
+
+        const bigint_t a("2a8e8ee7c1c6f6f63d7f3a5cfe1e49ed1f6b5f16e8e5c8a4b06b57c2d34f1d8e9a0b1c2d3e4f5061728394a5b6c7d8e9");
+        const bigint_t b = n - 1;
+
+        EXPECT_EQ(ctx.reduce(a * a), (a * a) % n);
+        EXPECT_EQ(ctx.reduce(b * b), bigint_t(1));
+        EXPECT_EQ(ctx.reduce(n * n * n + 5), bigint_t(5)); // above b^2k
+    }
+
+    EXPECT_EQ(barrett_context<uint32_t>(97).reduce(1000), 1000u % 97u);
+    EXPECT_ANY_THROW(barrett_context<bigint_t>(bigint_t(0)));
+}
+
+TEST(Test_Bigint, InlineStorage)
+{
+    const bigint_t a = pow(bigint_t(2), bigint_t(4095)) + 1;
+    const bigint_t b = a * a;
+
+    EXPECT_EQ(a.polynomial().capacity(), bigint_t::inline_limbs);
+    EXPECT_GT(b.polynomial().capacity(), bigint_t::inline_limbs);
+
+    EXPECT_EQ(b, pow(bigint_t(2), bigint_t(8190)) + pow(bigint_t(2), bigint_t(4096)) + 1);
+    EXPECT_EQ(b / a, a);
+
+    bigint_t c = b;
+    bigint_t d = a;
+
+    std::swap(c, d);
+    EXPECT_EQ(c, a);
+    EXPECT_EQ(d, b);
+}
+
+TEST(Test_Bigint, RvalueOperators)
+{
+    const bigint_t a("d0b750c8554b64c7a9d34d068e020fb52fea1b39c47971a359f0eec5da0437ea");
+    const bigint_t b("1f0e0d0c0b0a09080706050403020100ffeeddccbbaa9988");
+    const bigint_t c = 7;
+
+    EXPECT_EQ(a - b * c, a - bigint_t(b * c));
+    EXPECT_EQ(b * c - a, -(a - b * c));
+    EXPECT_EQ(bigint_t(a) + bigint_t(b), b + a);
+    EXPECT_EQ(bigint_t(b) - a, -(a - b));
+    EXPECT_EQ(bigint_t(a) * bigint_t(b), a * b);
+    EXPECT_EQ(bigint_t(a) / b, a / b);
+    EXPECT_EQ(bigint_t(a) % b, a % b);
+    EXPECT_EQ((bigint_t(a) & b) | bigint_t(b), b);
+    EXPECT_EQ(bigint_t(a) ^ a, bigint_t(0));
+
+    bigint_t x(a);
+    x += x;
+    EXPECT_EQ(x, a * 2);
+
+    x -= x;
+    EXPECT_EQ(x, bigint_t(0));
+    EXPECT_FALSE(x < 0);
+
+    x = -b;
+    x += a;
+    EXPECT_EQ(x, a - b);
+
+    x = b;
+    x -= a;
+    EXPECT_EQ(x + a, b);
+    EXPECT_TRUE(x < 0);
+
+    x *= x;
+    EXPECT_EQ(x, (a - b) * (a - b));
+
+    x %= a;
+    EXPECT_EQ(x, ((a - b) * (a - b)) % a);
 }
 
 TEST(Test_Bigint, StringInit)
@@ -1299,14 +1449,65 @@ TEST(Test_Bigint, OS2IP_IP2OS)
         auto os = I2OSP<bigint32_t>()(ip);
 
         ASSERT_BYTES_EQ(octets.begin(), octets.end(), os.begin(), os.end());
+    }*/
+
+    {
+        std::vector<uint8_t> octets = {1, 2, 3, 4, 5, 6, 7, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+        auto ip                     = OS2IP<bigint64_t>()(octets);
+
+        auto os = I2OSP<bigint64_t>()(ip);
+
+        EXPECT_TRUE(ASSERT_BYTES_EQ(octets.begin(), octets.end(), os.begin(), os.end()));
     }
+}
+
+TEST(Test_Bigint, Bigint64)
+{
+    EXPECT_EQ(bigint_t(65537).polynomial(), bigint_t::polynomial_type({0x00010001}));
+    EXPECT_EQ(bigint64_t(65537).polynomial(), bigint64_t::polynomial_type({0x00010001}));
+    EXPECT_EQ(basic_integer<byte>(65537).polynomial(), basic_integer<byte>::polynomial_type({0x00, 0x01, 0x00, 0x01}));
+
+    const std::string a_hex = "d0b750c8554b64c7a9d34d068e020fb52fea1b39c47971a359f0eec5da0437ea3fc94597d8dbff5444f6ce5a3293ac89";
+    const std::string b_hex = "1f0e0d0c0b0a09080706050403020100ffeeddccbbaa99887766554433221101";
+
+    const bigint64_t a(a_hex), b(b_hex);
+    const bigint_t a32(a_hex), b32(b_hex);
+
+    auto same = [](const bigint64_t& x, const bigint_t& y) {
+        const auto os64 = I2OSP<bigint64_t>()(x);
+        const auto os32 = I2OSP<bigint_t>()(y);
+
+        return ASSERT_BYTES_EQ(os64.begin(), os64.end(), os32.begin(), os32.end());
+    };
 
-	{
-		std::vector<uint8_t> octets = { 1, 2, 3, 4, 5, 6, 7, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
-		auto ip = OS2IP<bigint64_t>()(octets);
+    EXPECT_TRUE(same(a + b, a32 + b32));
+    EXPECT_TRUE(same(a - b, a32 - b32));
+    EXPECT_TRUE(same(a * b, a32 * b32));
+    EXPECT_TRUE(same(a * a, a32 * a32));
+    EXPECT_TRUE(same(a / b, a32 / b32));
+    EXPECT_TRUE(same(a % b, a32 % b32));
+    EXPECT_TRUE(same(a % 2003, a32 % 2003));
+    EXPECT_TRUE(same(pow_mod(b, a, a), pow_mod(b32, a32, a32)));
+    EXPECT_TRUE(same(pow_mod(a, b, b + 1), pow_mod(a32, b32, b32 + 1)));
+}
+
+TEST(Test_Bigint, ModWord)
+{
+    const std::string hex = "d0b750c8554b64c7a9d34d068e020fb52fea1b39c47971a359f0eec5da0437ea3fc94597d8dbff5444f6ce5a3293ac89";
+
+    const bigint_t a(hex);
+    const bigint64_t a64(hex);
+    const basic_integer<byte> a8(hex);
 
-		auto os = I2OSP<bigint64_t>()(ip);
+    for (uint32_t w : { 1u, 2u, 3u, 255u, 256u, 2003u, 17863u, 65537u, 0x7fffffffu, 0xffffffffu })
+    {
+        const uint32_t expected = OS2IP<uint32_t>()(I2OSP<bigint_t>()(a % bigint_t(w)));
+
+        EXPECT_EQ(a.mod_word(w), expected);
+        EXPECT_EQ(a64.mod_word(w), expected);
+        EXPECT_EQ(a8.mod_word(w), expected);
+    }
 
-		ASSERT_BYTES_EQ(octets.begin(), octets.end(), os.begin(), os.end());
-	}*/
-}
\ No newline at end of file
+    EXPECT_EQ(bigint_t(0).mod_word(7), 0u);
+    EXPECT_THROW(a.mod_word(0), std::runtime_error);
+}
@@ -3,6 +3,8 @@
 
 #include "cry_engine.hpp"
 
+#include <random>
+
 using namespace std;
 
 using byte = uint8_t;
@@ -73,6 +75,160 @@ TEST(Test_CryCore, Multiply) {
     MultiplyTest({0x02}, {0x00, 0x80}, {0x00, 0x01, 0x00});
 }
 
+TEST(Test_CryCore, MultiplyKaratsubaToom3) {
+    auto MultiplyTest = [](size_t len1, size_t len2) -> void {
+        std::mt19937 gen(static_cast<unsigned>(len1 * 1000 + len2));
+        std::uniform_int_distribution<> uid(0, 255);
+
+        std::vector<byte> a(len1), b(len2);
+        std::generate(a.begin(), a.end(), [&]() { return static_cast<byte>(uid(gen)); });
+        std::generate(b.begin(), b.end(), [&]() { return static_cast<byte>(uid(gen)); });
+
+        std::vector<byte> expected(len1 + len2);
+        Cry_multiply_schoolbook(&expected[0] + expected.size(), &a[0], &a[0] + len1, &b[0], &b[0] + len2);
+
+        std::vector<byte> actual(len1 + len2, 0xee);
+        Cry_multiply(&actual[0] + actual.size(), &a[0], &a[0] + len1, &b[0], &b[0] + len2);
+
+        EXPECT_TRUE(expected == actual);
+    };
+
+    const size_t karatsuba = Cry_karatsuba_threshold();
+    const size_t toom3     = Cry_toom3_threshold();
+
+    Cry_set_karatsuba_threshold(2);
+    Cry_set_toom3_threshold(6);
+
+    MultiplyTest(2, 2);
+    MultiplyTest(5, 4);
+    MultiplyTest(17, 16);
+    MultiplyTest(40, 3);
+    MultiplyTest(64, 64);
+    MultiplyTest(97, 80);
+    MultiplyTest(200, 150);
+    MultiplyTest(301, 77);
+
+    // cutoffs below 2 would recurse forever, they are clamped
+    Cry_set_karatsuba_threshold(0);
+    Cry_set_toom3_threshold(1);
+    EXPECT_EQ(Cry_karatsuba_threshold(), 2u);
+    EXPECT_EQ(Cry_toom3_threshold(), 2u);
+
+    MultiplyTest(4, 4);
+    MultiplyTest(9, 7);
+
+    Cry_set_karatsuba_threshold(karatsuba);
+    Cry_set_toom3_threshold(toom3);
+}
+
+TEST(Test_CryCore, Square) {
+    auto SquareTest = [](size_t len) -> void {
+        std::mt19937 gen(static_cast<unsigned>(len));
+        std::uniform_int_distribution<> uid(0, 255);
+
+        std::vector<byte> a(len);
+        std::generate(a.begin(), a.end(), [&]() { return static_cast<byte>(uid(gen)); });
+
+        std::vector<byte> expected(2 * len);
+        Cry_multiply_schoolbook(&expected[0] + expected.size(), &a[0], &a[0] + len, &a[0], &a[0] + len);
+
+        std::vector<byte> actual(2 * len, 0xee);
+        Cry_square(&actual[0] + actual.size(), &a[0], &a[0] + len);
+
+        EXPECT_TRUE(expected == actual);
+    };
+
+    SquareTest(1);
+    SquareTest(7);
+    SquareTest(64);
+
+    const size_t karatsuba = Cry_karatsuba_threshold();
+    const size_t toom3     = Cry_toom3_threshold();
+
+    Cry_set_karatsuba_threshold(2);
+    Cry_set_toom3_threshold(40);
+
+    SquareTest(5);
+    SquareTest(33);
+    SquareTest(97);
+
+    Cry_set_karatsuba_threshold(karatsuba);
+    Cry_set_toom3_threshold(toom3);
+}
+
+TEST(Test_CryCore, MultiBitShift) {
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<> uid(0, 255);
+
+    std::vector<byte> a(37);
+    std::generate(a.begin(), a.end(), [&]() { return static_cast<byte>(uid(gen)); });
+
+    for (int n : {0, 1, 7, 8, 9, 63, 64, 100, 295, 296, 500})
+    {
+        std::vector<byte> expected(a), actual(a);
+
+        for (int i = 0; i < n; ++i)
+        {
+            Cry_lshift(&expected[0], &expected[0] + expected.size());
+        }
+
+        Cry_lshift(&actual[0], &actual[0] + actual.size(), n);
+        EXPECT_TRUE(expected == actual);
+
+        expected = actual = a;
+
+        for (int i = 0; i < n; ++i)
+        {
+            Cry_rshift(&expected[0], &expected[0] + expected.size());
+        }
+
+        Cry_rshift(&actual[0], &actual[0] + actual.size(), n);
+        EXPECT_TRUE(expected == actual);
+    }
+}
+
+TEST(Test_CryCore, ScratchArena) {
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<> uid(0, 255);
+
+    std::vector<byte> a(120), b(90);
+    std::generate(a.begin(), a.end(), [&]() { return static_cast<byte>(uid(gen)); });
+    std::generate(b.begin(), b.end(), [&]() { return static_cast<byte>(uid(gen)); });
+
+    std::vector<byte> expected(a.size() + b.size());
+    Cry_multiply_schoolbook(&expected[0] + expected.size(), &a[0], &a[0] + a.size(), &b[0], &b[0] + b.size());
+
+    EXPECT_EQ(Cry_scratch_arena::current(), nullptr);
+
+    for (size_t nbytes : {64, 1 << 16})
+    {
+        Cry_scratch_arena arena(nbytes);
+
+        {
+            Cry_scratch_scope scope(arena);
+            EXPECT_EQ(Cry_scratch_arena::current(), &arena);
+
+            {
+                Cry_scratch<byte> held(16);
+                EXPECT_EQ(held[15], 0x00);
+                EXPECT_EQ(arena.used(), 16u);
+            }
+            EXPECT_EQ(arena.used(), 0u);
+
+            std::vector<byte> actual(a.size() + b.size());
+            Cry_multiply(&actual[0] + actual.size(), &a[0], &a[0] + a.size(), &b[0], &b[0] + b.size());
+
+            EXPECT_TRUE(expected == actual);
+            EXPECT_EQ(arena.used(), 0u);
+
+            Cry_scratch<byte> leaked(8);
+        }
+
+        EXPECT_EQ(arena.used(), 0u);
+        EXPECT_EQ(Cry_scratch_arena::current(), nullptr);
+    }
+}
+
 TEST(Test_CryCore, Subtract) {
     auto SubtractTest = [](const std::initializer_list<byte>& a, const std::initializer_list<byte>& b, const std::initializer_list<byte>& expected) -> void {
         byte actual[10] = {0x00};
@@ -86,6 +242,7 @@ TEST(Test_CryCore, Subtract) {
     SubtractTest({0x01, 0x01}, {0x02}, {0xff});
     SubtractTest({0x00, 0x01, 0x00}, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00}, {0x00});
     SubtractTest({0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01}, {0x00, 0x00, 0x00, 0x80}, {0x00, 0x81});
+    SubtractTest({0x01, 0x00, 0x00}, {0x01}, {0x00, 0xff, 0xff});
 }
 
 TEST(Test_CryCore, DivRem) {
@@ -121,6 +278,39 @@ TEST(Test_CryCore, DivRem) {
     DivRemTest({0x00, 0x00, 0x08}, {0x00, 0x00, 0x04}, {0x00, 0x00, 0x02}, {0x00, 0x00, 0x00});
 }
 
+TEST(Test_CryCore, DivRemKnuth) {
+    auto DivRemTest = [](size_t len1, size_t len2) -> void {
+        std::mt19937 gen(static_cast<unsigned>(len1 * 1000 + len2));
+        std::uniform_int_distribution<> uid(0, 255);
+
+        std::vector<byte> a(len1), b(len2);
+        std::generate(a.begin(), a.end(), [&]() { return static_cast<byte>(uid(gen)); });
+        std::generate(b.begin(), b.end(), [&]() { return static_cast<byte>(uid(gen)); });
+        b.front() |= 0x01;
+
+        std::vector<byte> div(len1), rem(len2);
+        std::vector<byte> workspace(Cry_divide_workspace_size(len1, len2));
+        Cry_divide(&div[0] + div.size(), &rem[0] + rem.size(), &a[0], &a[0] + len1, &b[0], &b[0] + len2, &workspace[0]);
+
+        EXPECT_EQ(Cry_compare(&rem[0], &rem[0] + rem.size(), &b[0], &b[0] + b.size()), -1);
+
+        // a == div * b + rem
+        std::vector<byte> actual(len1 + len2), sum(len1 + len2 + 1);
+        Cry_multiply(&actual[0] + actual.size(), &div[0], &div[0] + div.size(), &b[0], &b[0] + b.size());
+        Cry_add(&sum[0] + sum.size(), &actual[0], &actual[0] + actual.size(), &rem[0], &rem[0] + rem.size());
+
+        bool eq = ASSERT_BYTES_EQ<const byte*>(&a[0], &a[0] + a.size(), &sum[0], &sum[0] + sum.size());
+        EXPECT_TRUE(eq);
+    };
+
+    DivRemTest(2, 2);
+    DivRemTest(9, 1);
+    DivRemTest(16, 3);
+    DivRemTest(64, 17);
+    DivRemTest(128, 64);
+    DivRemTest(255, 254);
+}
+
 TEST(Test_CryCore, Increment) {
     auto IncrementTest = [](const std::initializer_list<byte>& _arg, const std::initializer_list<byte>& _expected) -> void {
         std::vector<byte> arg(_arg);
@@ -245,3 +435,77 @@ TEST(Test_CryCore, isOne) {
     IsOneTest({0x00, 0x00, 0x00, 0x00}, false);
     IsOneTest({0xff, 0x00, 0x00, 0x01}, false);
 }
+
+TEST(Test_CryCore, MontgomeryMultiply) {
+    auto MontgomeryMultiplyTest = [](const std::initializer_list<byte>& a, const std::initializer_list<byte>& b, const std::initializer_list<byte>& n, const std::initializer_list<byte>& expected) -> void {
+        byte actual[2]    = {0x00};
+        byte workspace[4] = {0x00};
+
+        const byte inverse = Cry_montgomery_inverse(begin(n), end(n));
+
+        Cry_montgomery_multiply(end(actual), begin(a), end(a), begin(b), end(b), begin(n), end(n), inverse, workspace);
+
+        auto eq = ASSERT_BYTES_EQ<const byte*>(begin(expected), end(expected), begin(actual), end(actual));
+
+        EXPECT_TRUE(eq);
+    };
+
+    const byte n0[] = {0x0b};
+    EXPECT_EQ(Cry_montgomery_inverse(begin(n0), end(n0)), 0x5d); // -11^-1 mod 256
+
+    MontgomeryMultiplyTest({0x00, 0x05}, {0x00, 0x07}, {0x03, 0x0b}, {0x01, 0x11}); // 5 * 7 * R^-1 mod 779 = 273
+    MontgomeryMultiplyTest({0x03, 0x00}, {0x03, 0x01}, {0x03, 0x0b}, {0x00, 0x4f});
+    MontgomeryMultiplyTest({0x03, 0x0a}, {0x03, 0x0a}, {0x03, 0x0b}, {0x02, 0x77});
+}
+
+TEST(Test_CryCore, MontgomerySquare) {
+    auto MontgomerySquareTest = [](const std::initializer_list<byte>& a, const std::initializer_list<byte>& n, const std::initializer_list<byte>& expected) -> void {
+        byte actual[2]    = {0x00};
+        byte workspace[5] = {0x00};
+
+        const byte inverse = Cry_montgomery_inverse(begin(n), end(n));
+
+        Cry_montgomery_square(end(actual), begin(a), end(a), begin(n), end(n), inverse, workspace);
+
+        auto eq = ASSERT_BYTES_EQ<const byte*>(begin(expected), end(expected), begin(actual), end(actual));
+
+        EXPECT_TRUE(eq);
+    };
+
+    MontgomerySquareTest({0x03, 0x0a}, {0x03, 0x0b}, {0x02, 0x77});
+    MontgomerySquareTest({0x00, 0x00}, {0x03, 0x0b}, {0x00, 0x00});
+    MontgomerySquareTest({0x01, 0x23}, {0x03, 0x0b}, {0x02, 0x1f});
+    MontgomerySquareTest({0x00, 0x01}, {0x03, 0x0b}, {0x02, 0x77}); // R^-1 mod 779
+}
+
+TEST(Test_CryCore, DivmodWord) {
+    // every divisor, including the ones that need no normalization shift
+    const byte a[] = {0xfe, 0x01, 0x80, 0x7f, 0x33};
+
+    uint64_t value = 0;
+    for (byte x : a)
+    {
+        value = (value << 8) | x;
+    }
+
+    for (unsigned d = 1; d != 256; ++d)
+    {
+        const Cry_word_divisor<byte> divisor = Cry_make_word_divisor(static_cast<byte>(d));
+
+        byte div[5]  = {0x00};
+        const byte r  = Cry_divmod_word(end(div), begin(a), end(a), divisor);
+
+        uint64_t q = 0;
+        for (byte x : div)
+        {
+            q = (q << 8) | x;
+        }
+
+        EXPECT_EQ(q, value / d);
+        EXPECT_EQ(r, value % d);
+        EXPECT_EQ(Cry_mod_word(begin(a), end(a), static_cast<byte>(d)), value % d);
+    }
+
+    const byte zero[] = {0x00, 0x00};
+    EXPECT_EQ(Cry_mod_word(begin(zero), end(zero), static_cast<byte>(7)), 0x00);
+}
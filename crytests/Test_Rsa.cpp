@@ -5,12 +5,19 @@
 
 #include "basic_integer.hpp"
 #include "rsa/emsa_pkcs1.hpp"
+#include "rsa/emsa_pss.hpp"
+#include "rsa/rsa.hpp"
 #include "utility/os2ip.hpp"
 #include "rsa/rsaes_oaep.hpp"
 #include "rsa/rsaes_pkcs1.hpp"
 #include "rsa/rsassa_pkcs1.hpp"
 #include "rsa/rsassa_pss.hpp"
+#include "rsa/signer_pool.hpp"
+#include "utility/worker_pool.hpp"
 #include "digest/sha1.hpp"
+#include "digest/sha256.hpp"
+
+#include <random>
 
 using namespace std;
 using namespace cry;
@@ -469,6 +476,40 @@ TEST(Test_Rsa, SigGen_SHA__1_RSA_PKCS_1024)
     }
 }
 
+TEST(Test_Rsa, SigGen_SHA__1_RSA_PKCS_1024_Bigint64)
+{
+    bigint64_t n("c8a2069182394a2ab7c3f4190c15589c56a2d4bc42dca675b34cc950e24663"
+                 "048441e8aa593b2bc59e198b8c257e882120c62336e5cc745012c7ffb063ee"
+                 "be53f3c6504cba6cfe51baa3b6d1074b2f398171f4b1982f4d65caf882ea4d"
+                 "56f32ab57d0c44e6ad4e9cf57a4339eb6962406e350c1b15397183fbf1f035"
+                 "3c9fc991");
+    bigint64_t e(65537);
+    bigint64_t d("5dfcb111072d29565ba1db3ec48f57645d9d8804ed598a4d470268a89067a2"
+                 "c921dff24ba2e37a3ce834555000dc868ee6588b7493303528b1b3a94f0b71"
+                 "730cf1e86fca5aeedc3afa16f65c0189d810ddcd81049ebbd0391868c50ede"
+                 "c958b3a2aaeff6a575897e2f20a3ab5455c1bfa55010ac51a7799b1ff84836"
+                 "44a3d425");
+    bigint64_t Msg("e8312742ae23c456ef28a23142c4490895832765dadce02afe5be5d31b"
+                   "0048fbeee2cf218b1747ad4fd81a2e17e124e6af17c3888e6d2d40c008"
+                   "07f423a233cad62ce9eaefb709856c94af166dba08e7a06965d7fc0d8e"
+                   "5cb26559c460e47bc088589d2242c9b3e62da4896fab199e144ec136db"
+                   "8d84ab84bcba04ca3b90c8e5");
+    bigint64_t S("28928e19eb86f9c00070a59edf6bf8433a45df495cd1c73613c2129840f4"
+                 "8c4a2c24f11df79bc5c0782bcedde97dbbb2acc6e512d19f085027cd5750"
+                 "38453d04905413e947e6e1dddbeb3535cdb3d8971fe0200506941056f212"
+                 "43503c83eadde053ed866c0e0250beddd927a08212aa8ac0efd61631ef89"
+                 "d8d049efb36bb35f");
+
+    std::vector<uint8_t> plain = I2OSP<bigint64_t>()(Msg);
+    std::vector<uint8_t> signature(128);
+
+    rsassa_pkcs1<sha1, bigint64_t>::sign(plain.begin(), plain.end(), signature.begin(), d, n, 1024);
+    EXPECT_EQ(OS2IP<bigint64_t>()(signature), S);
+
+    bool f = rsassa_pkcs1<sha1, bigint64_t>::verify(signature.begin(), signature.end(), plain.begin(), plain.end(), e, n, 1024);
+    EXPECT_EQ(f, true);
+}
+
 TEST(Test_Rsa, SigGen_SHA224_RSA_PKCS_1024)
 {
     auto test = [](const bigint_t& n, const bigint_t& e, const bigint_t& d, const bigint_t& Msg, const bigint_t& S) {
@@ -4295,6 +4336,12 @@ TEST(Test_Rsa, FIPS_186_4_RSA_PKCS1_v1_5_RSASP1_Signature_Primitive_Component)
 
             const bigint_t s = cry::pow_mod(EM, d, n);
             EXPECT_EQ(s, S);
+
+            private_key<bigint_t> key;
+            EXPECT_TRUE(make_private_key(key, p, q, e));
+            EXPECT_EQ(key.n, n);
+            EXPECT_EQ(rsadp(key, EM), S);
+            EXPECT_EQ(rsadp(key, EM, crt_mode::parallel), S);
         };
 
         // COUNT = 0
@@ -4613,3 +4660,858 @@ TEST(Test_Rsa, FIPS_186_4_RSA_PKCS1_v1_5_RSASP1_Signature_Primitive_Component)
                       "2c"));
     }
 }
+
+TEST(Test_Rsa, PrivateKey_CRT)
+{
+    private_key<bigint_t> key;
+    generate_key_pair(key, 65537, 1024);
+
+    EXPECT_TRUE(key.p > key.q);
+    EXPECT_EQ(key.p * key.q, key.n);
+    EXPECT_EQ((key.qInv * key.q) % key.p, bigint_t(1));
+
+    std::vector<uint8_t> m = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99 };
+
+    {
+        std::vector<uint8_t> S1(128), S2(128);
+        rsassa_pkcs1<>::sign(m.begin(), m.end(), S1.begin(), key);
+        rsassa_pkcs1<>::sign(m.begin(), m.end(), S2.begin(), key.d, key.n, 1024);
+        EXPECT_EQ(S1, S2);
+
+        rsassa_pkcs1<>::sign(m.begin(), m.end(), S2.begin(), key, crt_mode::parallel);
+        EXPECT_EQ(S1, S2);
+        EXPECT_TRUE(rsassa_pkcs1<>::verify(S1.begin(), S1.end(), m.begin(), m.end(), key.e, key.n, 1024));
+    }
+
+    const public_key<bigint_t> pub(key.n, key.e);
+    EXPECT_EQ(pub.bits(), 1024u);
+    EXPECT_EQ(pub.size(), 128u);
+    EXPECT_EQ(key.size(), 128u);
+
+    {
+        std::vector<uint8_t> S(128);
+        rsassa_pkcs1<>::sign(m.begin(), m.end(), S.begin(), key);
+        EXPECT_TRUE(rsassa_pkcs1<>::verify(S.begin(), S.end(), m.begin(), m.end(), pub));
+
+        S[5] ^= 0x01;
+        EXPECT_FALSE(rsassa_pkcs1<>::verify(S.begin(), S.end(), m.begin(), m.end(), pub));
+
+        // signature representative out of range
+        std::vector<uint8_t> N = I2OSP<bigint_t>()(key.n);
+        EXPECT_FALSE(rsassa_pkcs1<>::verify(N.begin(), N.end(), m.begin(), m.end(), pub));
+    }
+
+    {
+        const std::vector<uint8_t> salt(20, 0x5a);
+
+        std::vector<uint8_t> S1(128), S2(128);
+        rsassa_pss<>::sign(m.begin(), m.end(), S1.begin(), key, salt);
+        rsassa_pss<>::sign(m.begin(), m.end(), S2.begin(), key.n, key.d, 1024, salt);
+        EXPECT_EQ(S1, S2);
+    }
+
+    {
+        // copies share nothing with the original's cache
+        private_key<bigint_t> copy = key;
+        const std::vector<uint8_t> C = I2OSP<bigint_t>()(rsaep(pub, bigint_t(12345)));
+        EXPECT_EQ(rsadp(copy, OS2IP<bigint_t>()(C)), bigint_t(12345));
+    }
+
+    {
+        // fields changed after first use take effect once the caches are invalidated
+        private_key<bigint_t> other;
+        generate_key_pair(other, 65537, 1024);
+
+        private_key<bigint_t> reused = key;
+        public_key<bigint_t> reusedPub(key.n, key.e);
+        EXPECT_EQ(rsadp(reused, rsaep(reusedPub, bigint_t(12345))), bigint_t(12345));
+
+        reused.n    = other.n;
+        reused.d    = other.d;
+        reused.p    = other.p;
+        reused.q    = other.q;
+        reused.dP   = other.dP;
+        reused.dQ   = other.dQ;
+        reused.qInv = other.qInv;
+        reused.invalidate();
+
+        reusedPub.n = other.n;
+        reusedPub.invalidate();
+
+        const bigint_t c = rsaep(reusedPub, bigint_t(12345));
+        EXPECT_EQ(c, rsaep(public_key<bigint_t>(other.n, other.e), bigint_t(12345)));
+        EXPECT_EQ(rsadp(reused, c), bigint_t(12345));
+    }
+
+    {
+        std::vector<uint8_t> C(128), D(128);
+        rsaes_pkcs1<>::encrypt(m.begin(), m.end(), C.begin(), pub);
+
+        auto end = rsaes_pkcs1<>::decrypt(C.begin(), C.end(), D.begin(), key);
+        EXPECT_EQ(std::vector<uint8_t>(D.begin(), end), m);
+    }
+
+    {
+        std::vector<uint8_t> C(128), D(128);
+        rsaes_oaep<>::encrypt(m.begin(), m.end(), C.begin(), pub);
+
+        auto end = rsaes_oaep<>::decrypt(C.begin(), C.end(), D.begin(), key);
+        EXPECT_EQ(std::vector<uint8_t>(D.begin(), end), m);
+    }
+}
+
+TEST(Test_Rsa, PrivateKey_CRT_QGreaterThanP)
+{
+    private_key<bigint_t> generated;
+    generate_key_pair(generated, 65537, 1024);
+
+    // RFC 8017 does not order the primes: an imported key may come with q > p
+    private_key<bigint_t> key;
+    key.n  = generated.n;
+    key.e  = generated.e;
+    key.d  = generated.d;
+    key.p  = generated.q;
+    key.q  = generated.p;
+    key.dP = generated.dQ;
+    key.dQ = generated.dP;
+    ASSERT_TRUE(mod_inverse(key.qInv, key.q % key.p, key.p));
+    ASSERT_TRUE(key.q > key.p);
+
+    // unblinded, so the chosen representatives below reach the CRT step as they are
+    key.set_blinding(0);
+
+    const public_key<bigint_t> pub(key.n, key.e);
+
+    // x = 0 mod p and x = q - 1 mod q, so m_2 - m_1 exceeds p and a single + p cannot bring h back into range
+    bigint_t pInv;
+    ASSERT_TRUE(mod_inverse(pInv, key.p, key.q));
+    const bigint_t worst = key.p * (((key.q - 1) * pInv) % key.q);
+
+    for (const bigint_t& x : { bigint_t(2), bigint_t(12345), key.n - 2, key.p + 1, worst })
+    {
+        const bigint_t c = rsaep(pub, x);
+
+        EXPECT_EQ(rsadp(key, c), x);
+        EXPECT_EQ(rsadp(key, c, crt_mode::parallel), x);
+    }
+
+    std::vector<uint8_t> m = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99 };
+
+    std::vector<uint8_t> S1(128), S2(128);
+    rsassa_pkcs1<>::sign(m.begin(), m.end(), S1.begin(), key);
+    rsassa_pkcs1<>::sign(m.begin(), m.end(), S2.begin(), key.d, key.n, 1024);
+    EXPECT_EQ(S1, S2);
+    EXPECT_TRUE(rsassa_pkcs1<>::verify(S1.begin(), S1.end(), m.begin(), m.end(), pub));
+}
+
+TEST(Test_Rsa, Blinding)
+{
+    private_key<bigint_t> key;
+    generate_key_pair(key, 65537, 512);
+    EXPECT_TRUE(key.blinded());
+
+    const public_key<bigint_t> pub(key.n, key.e);
+
+    // squared pairs, regenerated pairs and pairs from the background reserve all unblind to the same result
+    key.set_blinding(3, 2);
+    for (uint32_t i = 2; i != 40; ++i)
+    {
+        const bigint_t m = bigint_t(i) * bigint_t(0x12345678) + bigint_t(i);
+        EXPECT_EQ(rsadp(key, rsaep(pub, m)), m);
+    }
+
+    std::vector<int> ok(64);
+    worker_pool::shared().parallel_for(ok.size(), [&](size_t i) {
+        const bigint_t m = bigint_t(static_cast<uint32_t>(i + 2));
+        ok[i] = rsadp(key, rsaep(pub, m), crt_mode::parallel) == m;
+    });
+    EXPECT_EQ(std::count(ok.begin(), ok.end(), 1), 64);
+
+    const bigint_t c = rsaep(pub, bigint_t(987654321));
+    const bigint_t blinded = rsadp(key, c);
+
+    key.set_blinding(0);
+    EXPECT_FALSE(key.blinded());
+    EXPECT_EQ(rsadp(key, c), blinded);
+
+    EXPECT_THROW(blinding<bigint_t>(key.n, bigint_t(0), 32, 2), std::logic_error);
+
+    {
+        // filled in by hand without e: the CRT runs unblinded instead of throwing
+        private_key<bigint_t> bare;
+        bare.n    = key.n;
+        bare.d    = key.d;
+        bare.p    = key.p;
+        bare.q    = key.q;
+        bare.dP   = key.dP;
+        bare.dQ   = key.dQ;
+        bare.qInv = key.qInv;
+
+        EXPECT_FALSE(bare.blinded());
+        EXPECT_EQ(rsadp(bare, c), blinded);
+        EXPECT_EQ(rsadp(bare, c, crt_mode::parallel), blinded);
+    }
+}
+
+TEST(Test_Rsa, MultiPrime)
+{
+    std::vector<uint8_t> m = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99 };
+
+    for (size_t nprimes : { 3, 4 })
+    {
+        private_key<bigint_t> key;
+        generate_key_pair_mt(key, 65537, 1024, nprimes);
+
+        ASSERT_EQ(key.primes(), nprimes);
+        EXPECT_EQ(key.bits(), 1024u);
+
+        bigint_t n = key.p * key.q;
+        for (const auto& info : key.others)
+        {
+            EXPECT_EQ((info.t * (n % info.r)) % info.r, bigint_t(1));
+            n *= info.r;
+        }
+        EXPECT_EQ(n, key.n);
+
+        const public_key<bigint_t> pub(key.n, key.e);
+
+        const bigint_t c = rsaep(pub, bigint_t(0x12345678) * bigint_t(0x9abcdef0));
+        EXPECT_EQ(rsadp(key, c), pow_mod(c, key.d, key.n));
+        EXPECT_EQ(rsadp(key, c, crt_mode::parallel), pow_mod(c, key.d, key.n));
+
+        {
+            std::vector<uint8_t> S1(128), S2(128);
+            rsassa_pkcs1<>::sign(m.begin(), m.end(), S1.begin(), key, crt_mode::parallel);
+            rsassa_pkcs1<>::sign(m.begin(), m.end(), S2.begin(), key.d, key.n, 1024);
+            EXPECT_EQ(S1, S2);
+            EXPECT_TRUE(rsassa_pkcs1<>::verify(S1.begin(), S1.end(), m.begin(), m.end(), pub));
+        }
+
+        {
+            std::vector<uint8_t> C(128), D(128);
+            rsaes_oaep<>::encrypt(m.begin(), m.end(), C.begin(), pub);
+
+            auto end = rsaes_oaep<>::decrypt(C.begin(), C.end(), D.begin(), key);
+            EXPECT_EQ(std::vector<uint8_t>(D.begin(), end), m);
+        }
+    }
+
+    {
+        private_key<bigint_t> key;
+        EXPECT_FALSE(make_private_key(key, std::vector<bigint_t>{ 11, 13, 11 }, bigint_t(7)));
+        EXPECT_TRUE(make_private_key(key, std::vector<bigint_t>{ 11, 13, 17 }, bigint_t(7)));
+        EXPECT_EQ(key.n, bigint_t(11 * 13 * 17));
+
+        key.set_blinding(0);
+        for (uint32_t x = 0; x < 11 * 13 * 17; x += 7)
+        {
+            EXPECT_EQ(rsadp(key, bigint_t(x)), pow_mod(bigint_t(x), key.d, key.n));
+        }
+    }
+}
+
+TEST(Test_Rsa, StreamingSignerVerifier)
+{
+    private_key<bigint_t> key;
+    generate_key_pair(key, 65537, 1024);
+
+    const public_key<bigint_t> pub(key.n, key.e);
+
+    std::vector<uint8_t> m(10000);
+    for (size_t i = 0; i != m.size(); ++i)
+    {
+        m[i] = static_cast<uint8_t>(i * 7 + 3);
+    }
+
+    auto feed = [&m](auto& stream) {
+        for (size_t offset = 0; offset < m.size(); offset += 37)
+        {
+            stream.update(m.data() + offset, std::min<size_t>(37, m.size() - offset));
+        }
+    };
+
+    {
+        using scheme = rsassa_pkcs1<sha256>;
+
+        std::vector<uint8_t> S1(128), S2(128);
+        scheme::sign(m.begin(), m.end(), S1.begin(), key);
+
+        scheme::signer signer(key);
+        feed(signer);
+        signer.finish(S2.begin());
+        EXPECT_EQ(S1, S2);
+
+        // finish starts a new message
+        signer.update(m.begin(), m.end()).finish(S2.begin());
+        EXPECT_EQ(S1, S2);
+
+        scheme::verifier verifier(pub);
+        feed(verifier);
+        EXPECT_TRUE(verifier.finish(S1.begin(), S1.end()));
+
+        S1[17] ^= 0x01;
+        feed(verifier);
+        EXPECT_FALSE(verifier.finish(S1.begin(), S1.end()));
+    }
+
+    {
+        const std::vector<uint8_t> salt(20, 0x5a);
+
+        std::vector<uint8_t> mHash(sha1::size);
+        sha1()(m.begin(), m.end(), mHash.begin());
+
+        std::vector<uint8_t> S1(128), S2(128);
+        rsassa_pss<>::sign_digest(mHash.begin(), mHash.end(), S1.begin(), key, salt);
+
+        rsassa_pss<>::signer signer(key, crt_mode::parallel);
+        feed(signer);
+        signer.finish(S2.begin(), salt);
+        EXPECT_EQ(S1, S2);
+
+        rsassa_pss<>::verifier verifier(pub);
+        feed(verifier);
+        EXPECT_TRUE(verifier.finish(S2.begin(), S2.end()));
+        EXPECT_TRUE(rsassa_pss<>::verify(m.begin(), m.end(), S2.begin(), S2.end(), pub));
+
+        std::vector<uint8_t> other(m.begin(), m.end() - 1);
+        verifier.update(other.begin(), other.end());
+        EXPECT_FALSE(verifier.finish(S2.begin(), S2.end()));
+    }
+}
+
+TEST(Test_Rsa, SignVerifyDigest)
+{
+    private_key<bigint_t> key;
+    generate_key_pair(key, 65537, 1024);
+
+    const public_key<bigint_t> pub(key.n, key.e);
+
+    std::vector<uint8_t> m = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99 };
+
+    {
+        using scheme = rsassa_pkcs1<sha256>;
+
+        std::vector<uint8_t> hash(sha256::size);
+        sha256()(m.begin(), m.end(), hash.begin());
+
+        std::vector<uint8_t> S1(128), S2(128), S3(128);
+        scheme::sign(m.begin(), m.end(), S1.begin(), key);
+        scheme::sign_digest(hash.begin(), hash.end(), S2.begin(), key);
+        scheme::sign_digest(hash.begin(), hash.end(), S3.begin(), key.d, key.n, 1024);
+        EXPECT_EQ(S1, S2);
+        EXPECT_EQ(S1, S3);
+
+        EXPECT_TRUE(scheme::verify_digest(S1.begin(), S1.end(), hash.begin(), hash.end(), pub));
+        EXPECT_TRUE(scheme::verify_digest(S1.begin(), S1.end(), hash.begin(), hash.end(), key.e, key.n, 1024));
+
+        hash[0] ^= 0x01;
+        EXPECT_FALSE(scheme::verify_digest(S1.begin(), S1.end(), hash.begin(), hash.end(), pub));
+
+        EXPECT_THROW(scheme::sign_digest(m.begin(), m.end(), S2.begin(), key), std::runtime_error);
+    }
+
+    {
+        const std::vector<uint8_t> salt(20, 0x5a);
+
+        std::vector<uint8_t> mHash(sha1::size);
+        sha1()(m.begin(), m.end(), mHash.begin());
+
+        // sign hashes the message, sign_digest takes mHash
+        std::vector<uint8_t> S1(128), S2(128);
+        rsassa_pss<>::sign(m.begin(), m.end(), S1.begin(), key, salt);
+        rsassa_pss<>::sign_digest(mHash.begin(), mHash.end(), S2.begin(), key.n, key.d, 1024, salt);
+        EXPECT_EQ(S1, S2);
+
+        EXPECT_TRUE(rsassa_pss<>::verify(m.begin(), m.end(), S1.begin(), S1.end(), pub));
+        EXPECT_TRUE(rsassa_pss<>::verify_digest(mHash.begin(), mHash.end(), S1.begin(), S1.end(), pub));
+        EXPECT_TRUE(rsassa_pss<>::verify_digest(mHash.begin(), mHash.end(), S1.begin(), S1.end(), key.n, key.e, 1024));
+
+        // random salts
+        for (int i = 0; i != 8; ++i)
+        {
+            rsassa_pss<>::sign(m.begin(), m.end(), S1.begin(), key);
+            EXPECT_TRUE(rsassa_pss<>::verify(m.begin(), m.end(), S1.begin(), S1.end(), pub));
+        }
+
+        EXPECT_THROW(rsassa_pss<>::verify_digest(m.begin(), m.end(), S1.begin(), S1.end(), pub), std::runtime_error);
+    }
+
+    {
+        // k = 130 octets is not a whole number of limbs: S must still be exactly k octets
+        private_key<bigint_t> odd;
+        generate_key_pair(odd, 65537, 1040);
+        ASSERT_EQ(odd.size(), 130u);
+
+        const public_key<bigint_t> oddPub(odd.n, odd.e);
+
+        std::vector<uint8_t> hash(sha1::size);
+        sha1()(m.begin(), m.end(), hash.begin());
+
+        std::vector<uint8_t> S(odd.size() + 8, 0xee);
+
+        auto end = rsassa_pkcs1<>::sign_digest(hash.begin(), hash.end(), S.begin(), odd);
+        EXPECT_EQ(end - S.begin(), 130);
+        EXPECT_EQ(S[130], 0xee);
+        EXPECT_TRUE(rsassa_pkcs1<>::verify(S.begin(), end, m.begin(), m.end(), oddPub));
+
+        end = rsassa_pss<>::sign_digest(hash.begin(), hash.end(), S.begin(), odd);
+        EXPECT_EQ(end - S.begin(), 130);
+        EXPECT_EQ(S[130], 0xee);
+        EXPECT_TRUE(rsassa_pss<>::verify(m.begin(), m.end(), S.begin(), end, oddPub));
+    }
+}
+
+TEST(Test_Rsa, PssOddModulusLength)
+{
+    // p has 512 bits and q 513, both with their top two bits set: n has exactly 1025 bits, k = 129, emLen = 128
+    bigint_t p;
+    generate_probably_prime(p, 512);
+
+    std::mt19937 gen(1025);
+    std::uniform_int_distribution<> uid(0, 255);
+
+    std::vector<uint8_t> bytes(65);
+    std::generate(bytes.begin(), bytes.end(), [&]() { return static_cast<uint8_t>(uid(gen)); });
+    bytes[0] = 0x01;
+    bytes[1] |= 0x80;
+    bytes[64] |= 0x01;
+
+    bigint_t q = OS2IP<bigint_t>()(bytes);
+    while (!is_probably_prime(q, 20) || gcd(q - 1, bigint_t(65537)) != 1)
+    {
+        q += 2;
+    }
+
+    private_key<bigint_t> key;
+    ASSERT_TRUE(make_private_key(key, p, q, bigint_t(65537)));
+    ASSERT_EQ(key.bits(), 1025u);
+    ASSERT_EQ(key.size(), 129u);
+
+    const public_key<bigint_t> pub(key.n, key.e);
+
+    std::vector<uint8_t> m = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99 };
+
+    std::vector<uint8_t> mHash(sha1::size);
+    sha1()(m.begin(), m.end(), mHash.begin());
+
+    std::vector<uint8_t> S(129);
+    auto end = rsassa_pss<>::sign(m.begin(), m.end(), S.begin(), key);
+    EXPECT_EQ(end, S.end());
+
+    EXPECT_TRUE(rsassa_pss<>::verify(m.begin(), m.end(), S.begin(), S.end(), pub));
+    EXPECT_TRUE(rsassa_pss<>::verify(m.begin(), m.end(), S.begin(), S.end(), key.n, key.e, 1025));
+    EXPECT_TRUE(rsassa_pss<>::verify_digest(mHash.begin(), mHash.end(), S.begin(), S.end(), pub));
+
+    rsassa_pss<>::verifier verifier(pub);
+    verifier.update(m.data(), m.size());
+    EXPECT_TRUE(verifier.finish(S.begin(), S.end()));
+
+    const std::vector<signed_message> items = { { m.data(), m.size(), S.data(), S.size() }, { m.data(), m.size(), S.data(), S.size() - 1 } };
+    const std::vector<bool> verdicts = rsassa_pss<>::verify_batch(items.begin(), items.end(), pub);
+    EXPECT_TRUE(verdicts[0]);
+    EXPECT_FALSE(verdicts[1]);
+
+    // one octet short is rejected on every path
+    EXPECT_FALSE(rsassa_pss<>::verify(m.begin(), m.end(), S.begin() + 1, S.end(), pub));
+}
+
+TEST(Test_Rsa, StatusCodes)
+{
+    private_key<bigint_t> key;
+    generate_key_pair(key, 65537, 1024);
+
+    const public_key<bigint_t> pub(key.n, key.e);
+
+    std::vector<uint8_t> m = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99 };
+
+    auto check = [&](auto scheme, std::vector<uint8_t> C) {
+        using scheme_type = decltype(scheme);
+
+        std::vector<uint8_t> M(128);
+        size_t mLen = 0;
+
+        EXPECT_EQ(scheme_type::try_decrypt(C.data(), C.size(), M.data(), M.size(), mLen, key), status::ok);
+        EXPECT_EQ(std::vector<uint8_t>(M.begin(), M.begin() + mLen), m);
+
+        EXPECT_EQ(scheme_type::try_decrypt(C.data(), C.size(), M.data(), M.size(), mLen, key.d, key.n, 1024), status::ok);
+        EXPECT_EQ(mLen, m.size());
+
+        EXPECT_EQ(scheme_type::try_decrypt(C.data(), C.size(), M.data(), 4, mLen, key), status::buffer_too_small);
+        EXPECT_EQ(scheme_type::try_decrypt(C.data(), C.size() - 1, M.data(), M.size(), mLen, key), status::decryption_error);
+
+        const std::vector<uint8_t> N = I2OSP<bigint_t>()(key.n);
+        EXPECT_EQ(scheme_type::try_decrypt(N.data(), N.size(), M.data(), M.size(), mLen, key), status::decryption_error);
+
+        C[64] ^= 0x01;
+        EXPECT_EQ(scheme_type::try_decrypt(C.data(), C.size(), M.data(), M.size(), mLen, key), status::decryption_error);
+        EXPECT_EQ(mLen, 0u);
+
+        // the throwing API sits on top
+        EXPECT_THROW(scheme_type::decrypt(C.begin(), C.end(), M.begin(), key), std::runtime_error);
+    };
+
+    {
+        std::vector<uint8_t> C(128);
+        rsaes_oaep<>::encrypt(m.begin(), m.end(), C.begin(), pub);
+        check(rsaes_oaep<>(), C);
+    }
+
+    {
+        std::vector<uint8_t> C(128);
+        rsaes_pkcs1<>::encrypt(m.begin(), m.end(), C.begin(), pub);
+        check(rsaes_pkcs1<>(), C);
+    }
+
+    {
+        using encoding = emsa_pss<>;
+
+        const std::vector<uint8_t> salt(20, 0x5a);
+
+        std::vector<uint8_t> EM(128);
+        EXPECT_EQ(encoding::try_encode(m.data(), m.size(), EM.data(), EM.size(), 1023, salt), status::ok);
+
+        std::vector<uint8_t> EM_(128);
+        encoding::encode(m.begin(), m.end(), EM_.begin(), 1023, salt);
+        EXPECT_EQ(EM, EM_);
+
+        std::vector<uint8_t> mHash(sha1::size);
+        sha1()(m.begin(), m.end(), mHash.begin());
+        EXPECT_EQ(encoding::try_verify_hash(mHash.data(), EM.data(), EM.size(), 1023), status::ok);
+
+        EM[40] ^= 0x01;
+        EXPECT_EQ(encoding::try_verify_hash(mHash.data(), EM.data(), EM.size(), 1023), status::inconsistent);
+        EXPECT_FALSE(encoding::verify(m.begin(), m.end(), EM.begin(), EM.end(), 1023));
+
+        EXPECT_EQ(encoding::try_encode(m.data(), m.size(), EM.data(), 127, 1023), status::buffer_too_small);
+        EXPECT_EQ(encoding::try_encode(m.data(), m.size(), EM.data(), EM.size(), 300), status::encoding_error);
+        EXPECT_EQ(encoding::try_encode(m.data(), m.size(), EM.data(), EM.size(), 1023, std::vector<uint8_t>(19)), status::encoding_error);
+    }
+}
+
+TEST(Test_Rsa, Workspaces)
+{
+    const std::vector<uint8_t> m = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99 };
+    const std::vector<uint8_t> L = { 'l', 'a', 'b', 'e', 'l' };
+
+    {
+        using encoding = eme_oaep<>;
+
+        const std::vector<uint8_t> seed(sha1::size, 0x3c);
+
+        std::vector<uint8_t> EM(128), workspace(encoding::workspace_size(128));
+        EXPECT_EQ(encoding::try_encode(m.data(), m.size(), EM.data(), EM.size(), seed.data(), L.data(), L.size()), status::ok);
+
+        std::vector<uint8_t> EM_(128);
+        encoding::encode(m.begin(), m.end(), EM_.begin(), 128, seed, L);
+        EXPECT_EQ(EM, EM_);
+
+        std::vector<uint8_t> M(128);
+        size_t mLen = 0;
+        EXPECT_EQ(encoding::try_decode(EM.data(), EM.size(), M.data(), M.size(), mLen, L.data(), L.size(), workspace.data()), status::ok);
+        EXPECT_EQ(std::vector<uint8_t>(M.begin(), M.begin() + mLen), m);
+
+        EXPECT_EQ(encoding::try_decode(EM.data(), EM.size(), M.data(), M.size(), mLen, L.data(), L.size() - 1, workspace.data()), status::decryption_error);
+
+        const std::vector<uint8_t> big(128 - 2 * sha1::size - 1);
+        EXPECT_EQ(encoding::try_encode(big.data(), big.size(), EM.data(), EM.size(), nullptr, nullptr, 0), status::message_too_long);
+    }
+
+    {
+        using encoding = emsa_pss<>;
+
+        const std::vector<uint8_t> salt(20, 0x5a);
+
+        std::vector<uint8_t> EM(128), workspace(encoding::workspace_size(128));
+        EXPECT_EQ(encoding::try_encode(m.data(), m.size(), EM.data(), EM.size(), 1023, salt.data(), workspace.data()), status::ok);
+
+        std::vector<uint8_t> EM_(128);
+        encoding::encode(m.begin(), m.end(), EM_.begin(), 1023, salt);
+        EXPECT_EQ(EM, EM_);
+
+        uint8_t mHash[sha1::size];
+        sha1()(m.begin(), m.end(), mHash);
+        EXPECT_EQ(encoding::try_verify_hash(mHash, EM.data(), EM.size(), 1023, workspace.data()), status::ok);
+
+        // a random salt still verifies
+        EXPECT_EQ(encoding::try_encode_hash(mHash, EM.data(), EM.size(), 1023, nullptr, workspace.data()), status::ok);
+        EXPECT_EQ(encoding::try_verify_hash(mHash, EM.data(), EM.size(), 1023, workspace.data()), status::ok);
+
+        mHash[0] ^= 0x01;
+        EXPECT_EQ(encoding::try_verify_hash(mHash, EM.data(), EM.size(), 1023, workspace.data()), status::inconsistent);
+    }
+
+    {
+        const std::vector<uint8_t> ps(128 - m.size() - 3, 0xa5);
+
+        std::vector<uint8_t> EM(128);
+        EXPECT_EQ(eme_pkcs1::try_encode(m.data(), m.size(), EM.data(), EM.size(), ps.data()), status::ok);
+
+        std::vector<uint8_t> EM_(128);
+        eme_pkcs1::encode(m.begin(), m.end(), EM_.begin(), 128, ps);
+        EXPECT_EQ(EM, EM_);
+
+        EXPECT_EQ(eme_pkcs1::try_encode(m.data(), m.size(), EM.data(), 19), status::message_too_long);
+    }
+
+    {
+        std::vector<uint8_t> EM(128);
+        EXPECT_EQ(emsa_pkcs1<sha256>::try_encode(m.data(), m.size(), EM.data(), EM.size()), status::ok);
+
+        std::vector<uint8_t> EM_(128);
+        emsa_pkcs1<sha256>::encode(m.begin(), m.end(), EM_.begin(), 128);
+        EXPECT_EQ(EM, EM_);
+
+        EXPECT_EQ(emsa_pkcs1<sha256>::try_encode(m.data(), m.size(), EM.data(), 40), status::encoding_error);
+    }
+}
+
+TEST(Test_Rsa, Mgf1)
+{
+    std::vector<uint8_t> seed(100);
+    for (size_t i = 0; i != seed.size(); ++i)
+    {
+        seed[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    // T = Hash(seed || 0) || Hash(seed || 1) || ..., straight from RFC 8017 B.2.1
+    auto reference = [&seed](size_t maskLen) {
+        std::vector<uint8_t> T;
+        for (uint32_t i = 0; T.size() < maskLen; ++i)
+        {
+            std::vector<uint8_t> block(seed);
+            block.insert(block.end(), { static_cast<uint8_t>(i >> 24), static_cast<uint8_t>(i >> 16), static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i) });
+
+            uint8_t hash[sha256::size];
+            sha256()(block.begin(), block.end(), hash);
+            T.insert(T.end(), hash, hash + sha256::size);
+        }
+
+        T.resize(maskLen);
+        return T;
+    };
+
+    for (size_t maskLen : { 0, 1, 31, 32, 33, 200 })
+    {
+        std::vector<uint8_t> mask(maskLen);
+        mgf1<sha256>()(seed.begin(), seed.end(), mask.begin(), maskLen);
+        EXPECT_EQ(mask, reference(maskLen));
+
+        // XOR in place: x ^ mask ^ mask == x
+        std::vector<uint8_t> target(seed.begin(), seed.begin() + std::min(maskLen, seed.size()));
+        target.resize(maskLen, 0x5a);
+        const std::vector<uint8_t> original = target;
+
+        mgf1<sha256>().mask(seed.begin(), seed.end(), target.data(), maskLen);
+        for (size_t i = 0; i != maskLen; ++i)
+        {
+            EXPECT_EQ(target[i], original[i] ^ mask[i]);
+        }
+    }
+
+    // a copied digest finishes the shared prefix independently
+    sha1 prefix;
+    prefix.Init();
+    prefix.Update(seed.begin(), seed.begin() + 70);
+
+    sha1 copy(prefix);
+    copy.Update(seed.begin() + 70, seed.end());
+
+    uint8_t h1[sha1::size], h2[sha1::size];
+    copy.Final(h1);
+    sha1()(seed.begin(), seed.end(), h2);
+    EXPECT_TRUE(std::equal(h1, h1 + sha1::size, h2));
+}
+
+TEST(Test_Rsa, WorkerPool)
+{
+    worker_pool pool(2);
+    EXPECT_EQ(pool.size(), 2u);
+
+    int a = 0, b = 0;
+    pool.invoke([&] { a = 1; }, [&] { b = 2; });
+    EXPECT_EQ(a + b, 3);
+
+    // nested calls from the workers themselves must not deadlock
+    std::atomic<int> count(0);
+    auto leaf = [&] { ++count; };
+    auto node = [&] { pool.invoke(leaf, leaf); };
+    pool.invoke([&] { pool.invoke(node, node); }, [&] { pool.invoke(node, node); });
+    EXPECT_EQ(count.load(), 8);
+
+    EXPECT_THROW(pool.invoke([] {}, [] { throw std::runtime_error("q half"); }), std::runtime_error);
+
+    std::vector<int> hits(1000);
+    pool.parallel_for(hits.size(), [&](size_t i) { hits[i] += 1; });
+    EXPECT_EQ(std::count(hits.begin(), hits.end(), 1), 1000);
+
+    count = 0;
+    pool.parallel_for(4, [&](size_t) { pool.parallel_for(4, [&](size_t) { ++count; }); });
+    EXPECT_EQ(count.load(), 16);
+}
+
+TEST(Test_Rsa, VerifyBatch)
+{
+    private_key<bigint_t> key;
+    generate_key_pair(key, 65537, 1024);
+
+    const public_key<bigint_t> pub(key.n, key.e);
+
+    const size_t count = 150;
+
+    std::vector<std::vector<uint8_t>> messages(count), pkcs1(count, std::vector<uint8_t>(128)), pss(count, std::vector<uint8_t>(128));
+    for (size_t i = 0; i != count; ++i)
+    {
+        messages[i] = { static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8), 0x42 };
+
+        rsassa_pkcs1<>::sign(messages[i].begin(), messages[i].end(), pkcs1[i].begin(), key);
+
+        rsassa_pss<>::sign(messages[i].begin(), messages[i].end(), pss[i].begin(), key);
+    }
+
+    // corrupt every 7th signature, truncate every 11th
+    std::vector<signed_message> items1(count), items2(count);
+    for (size_t i = 0; i != count; ++i)
+    {
+        if (i % 7 == 3)
+        {
+            pkcs1[i][10] ^= 0x01;
+            pss[i][10] ^= 0x01;
+        }
+
+        const size_t size = i % 11 == 5 ? 127 : 128;
+
+        items1[i] = { messages[i].data(), messages[i].size(), pkcs1[i].data(), size };
+        items2[i] = { messages[i].data(), messages[i].size(), pss[i].data(), size };
+    }
+
+    const std::vector<bool> r1 = rsassa_pkcs1<>::verify_batch(items1.begin(), items1.end(), pub);
+    const std::vector<bool> r2 = rsassa_pss<>::verify_batch(items2.begin(), items2.end(), pub);
+
+    ASSERT_EQ(r1.size(), count);
+    ASSERT_EQ(r2.size(), count);
+
+    for (size_t i = 0; i != count; ++i)
+    {
+        const bool expected = i % 7 != 3 && i % 11 != 5;
+
+        EXPECT_EQ(r1[i], expected) << i;
+        EXPECT_EQ(r2[i], expected) << i;
+
+        // the single-signature paths give the same verdicts
+        const size_t size = items1[i].signature_size;
+        EXPECT_EQ(rsassa_pkcs1<>::verify(pkcs1[i].begin(), pkcs1[i].begin() + size, messages[i].begin(), messages[i].end(), pub), r1[i]) << i;
+        EXPECT_EQ(rsassa_pss<>::verify(messages[i].begin(), messages[i].end(), pss[i].begin(), pss[i].begin() + size, pub), r2[i]) << i;
+    }
+
+    {
+        // representative out of range and one octet too many, rejected alike by both paths
+        std::vector<uint8_t> N = I2OSP<bigint_t>()(key.n);
+        std::vector<uint8_t> L(pss[0]);
+        L.insert(L.begin(), 0x00);
+
+        const std::vector<signed_message> bad = { { messages[0].data(), messages[0].size(), N.data(), N.size() }, { messages[0].data(), messages[0].size(), L.data(), L.size() } };
+
+        for (bool verified : rsassa_pss<>::verify_batch(bad.begin(), bad.end(), pub))
+        {
+            EXPECT_FALSE(verified);
+        }
+        for (bool verified : rsassa_pkcs1<>::verify_batch(bad.begin(), bad.end(), pub))
+        {
+            EXPECT_FALSE(verified);
+        }
+
+        EXPECT_FALSE(rsassa_pss<>::verify(messages[0].begin(), messages[0].end(), N.begin(), N.end(), pub));
+        EXPECT_FALSE(rsassa_pss<>::verify(messages[0].begin(), messages[0].end(), L.begin(), L.end(), pub));
+        EXPECT_FALSE(rsassa_pkcs1<>::verify(N.begin(), N.end(), messages[0].begin(), messages[0].end(), pub));
+        EXPECT_FALSE(rsassa_pkcs1<>::verify(L.begin(), L.end(), messages[0].begin(), messages[0].end(), pub));
+    }
+
+    EXPECT_TRUE(rsassa_pkcs1<>::verify_batch(items1.begin(), items1.begin(), pub).empty());
+}
+
+TEST(Test_Rsa, SignerPool)
+{
+    private_key<bigint_t> key;
+    generate_key_pair(key, 65537, 1024);
+
+    const size_t count = 64;
+
+    std::vector<std::vector<uint8_t>> messages(count);
+    for (size_t i = 0; i != count; ++i)
+    {
+        messages[i] = { static_cast<uint8_t>(i), 0x17, 0x29 };
+    }
+
+    std::atomic<size_t> callbacks(0);
+    {
+        signer_pool<rsassa_pkcs1<>> pool(key, 4);
+        EXPECT_EQ(pool.size(), 4u);
+
+        std::vector<std::future<std::vector<uint8_t>>> futures;
+        for (const auto& message : messages)
+        {
+            futures.push_back(pool.sign(message));
+        }
+
+        for (size_t i = 0; i != count; ++i)
+        {
+            std::vector<uint8_t> expected(128);
+            rsassa_pkcs1<>::sign(messages[i].begin(), messages[i].end(), expected.begin(), key);
+
+            EXPECT_EQ(futures[i].get(), expected);
+        }
+
+        for (const auto& message : messages)
+        {
+            pool.sign(message, [&callbacks](std::exception_ptr error, std::vector<uint8_t> signature) {
+                if (!error && signature.size() == 128)
+                {
+                    ++callbacks;
+                }
+            });
+        }
+    }
+
+    // the destructor drains the queues
+    EXPECT_EQ(callbacks.load(), count);
+
+    {
+        signer_pool<rsassa_pss<sha256>> pool(key, 2);
+
+        std::vector<std::future<std::vector<uint8_t>>> futures;
+        for (const auto& message : messages)
+        {
+            std::vector<uint8_t> digest(sha256::size);
+            sha256()(message.begin(), message.end(), digest.begin());
+
+            futures.push_back(pool.sign_digest(digest));
+        }
+
+        const public_key<bigint_t> pub(key.n, key.e);
+        for (size_t i = 0; i != count; ++i)
+        {
+            const std::vector<uint8_t> signature = futures[i].get();
+            EXPECT_TRUE(rsassa_pss<sha256>::verify(messages[i].begin(), messages[i].end(), signature.begin(), signature.end(), pub));
+        }
+
+        // a digest of the wrong length comes back as the scheme's exception
+        EXPECT_THROW(pool.sign_digest(std::vector<uint8_t>(20)).get(), std::runtime_error);
+
+    }
+
+    std::vector<uint8_t> digest(sha256::size);
+    sha256()(messages[0].begin(), messages[0].end(), digest.begin());
+
+    std::vector<uint8_t> expected(128);
+    rsassa_pkcs1<sha256>::sign(messages[0].begin(), messages[0].end(), expected.begin(), key);
+
+    std::atomic<bool> matched(false);
+    {
+        signer_pool<rsassa_pkcs1<sha256>> pool(key, 2);
+        pool.sign_digest(digest, [&matched, &expected](std::exception_ptr error, std::vector<uint8_t> signature) {
+            matched = !error && signature == expected;
+        });
+    }
+
+    EXPECT_TRUE(matched.load());
+}
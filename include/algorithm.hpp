@@ -84,6 +84,155 @@ namespace cry
                 return (*(--end) & 0x01) == 0x00;
             }
         };
+
+        template <class P>
+        size_t bit_length(const cry::basic_integer<P>& x) noexcept
+        {
+            const auto& polynomial = x.polynomial();
+
+            auto first  = polynomial.begin();
+            auto nwords = polynomial.size();
+            for (; first != polynomial.end() && *first == 0x00; ++first, --nwords)
+                ;
+
+            if (nwords == 0)
+            {
+                return 0;
+            }
+
+            size_t nbits = (nwords - 1) * sizeof(P) * 8;
+            for (P top = *first; top != 0x00; top >>= 1)
+            {
+                ++nbits;
+            }
+
+            return nbits;
+        }
+
+        template <class P>
+        bool test_bit(const cry::basic_integer<P>& x, size_t n) noexcept
+        {
+            const auto& polynomial = x.polynomial();
+
+            const size_t idx = n / (sizeof(P) * 8);
+            if (idx >= polynomial.size())
+            {
+                return false;
+            }
+
+            return ((polynomial[polynomial.size() - 1 - idx] >> (n % (sizeof(P) * 8))) & 0x01) == 0x01;
+        }
+
+        /**
+         * \brief fetches a non-negative value of at most 32 bits as a machine word
+         * \return returns "FALSE" if x does not fit
+         */
+        template <class P>
+        bool to_word(const cry::basic_integer<P>& x, uint32_t& word) noexcept
+        {
+            if (x < 0 || bit_length(x) > 32)
+            {
+                return false;
+            }
+
+            uint64_t w = 0;
+            for (P limb : x.polynomial())
+            {
+                w = (w << (4 * sizeof(P)) << (4 * sizeof(P))) | limb;
+            }
+
+            word = static_cast<uint32_t>(w);
+
+            return true;
+        }
+
+        constexpr size_t window_size(size_t nbits) noexcept
+        {
+            return (nbits) > 671 ? 6 : (nbits) > 239 ? 5 : (nbits) > 79 ? 4 : (nbits) > 23 ? 3 : 1;
+        }
+
+        /**
+         * \brief left-to-right sliding-window exponentiation with a table of odd powers of the base
+         * \param base base value
+         * \param exp exponent
+         * \param one multiplicative identity
+         * \param multiply multiply(out, a, b) stores the (modular) product a * b in out, out may alias a or b
+         * \param square square(out, a) stores the (modular) square a * a in out, out may alias a
+         */
+        template <class Value, class Integer, class Multiply, class Square>
+        Value sliding_window_pow(const Value& base, const Integer& exp, const Value& one, Multiply multiply, Square square)
+        {
+            const size_t nbits = bit_length(exp);
+            if (nbits == 0)
+            {
+                return one;
+            }
+
+            const size_t wsize = window_size(nbits);
+
+            ////////////////////////////////////////////////////
+            // base, base^3, base^5, ..., base^(2^wsize - 1)
+            std::vector<Value> table(static_cast<size_t>(1) << (wsize - 1), base);
+            if (table.size() > 1)
+            {
+                Value base2 = base;
+                square(base2, base);
+
+                for (size_t i = 1; i < table.size(); ++i)
+                {
+                    multiply(table[i], table[i - 1], base2);
+                }
+            }
+
+            Value y      = one;
+            bool started = false;
+
+            for (size_t i = nbits; i > 0;)
+            {
+                if (!test_bit(exp, i - 1))
+                {
+                    if (started)
+                    {
+                        square(y, y);
+                    }
+
+                    --i;
+                    continue;
+                }
+
+                //////////////////////////////////////////////////////////
+                // the longest window [l, i) not longer than wsize bits
+                // that ends with a set bit
+                size_t l = (i > wsize) ? i - wsize : 0;
+                for (; !test_bit(exp, l); ++l)
+                    ;
+
+                size_t window = 0;
+                for (size_t j = i; j > l; --j)
+                {
+                    window = (window << 1) | (test_bit(exp, j - 1) ? 0x01 : 0x00);
+
+                    if (started)
+                    {
+                        square(y, y);
+                    }
+                }
+
+                if (started)
+                {
+                    multiply(y, y, table[window >> 1]);
+                }
+                else
+                {
+                    y       = table[window >> 1];
+                    started = true;
+                }
+
+                i = l;
+            }
+
+            return y;
+        }
     }
 
     /**
@@ -104,8 +253,8 @@ namespace cry
         while (r2 != 0)
         {
             auto rem = r1 % r2;
-            r1       = r2;
-            r2       = rem;
+            r1       = std::move(r2);
+            r2       = std::move(rem);
         }
 
         return r1;
@@ -140,13 +289,13 @@ namespace cry
 
             r1.divide(q, r, r2);
 
-            r1 = r2;
-            r2 = r;
+            r1 = std::move(r2);
+            r2 = std::move(r);
 
             T t = (t1 - q * t2);
 
-            t1 = t2;
-            t2 = t;
+            t1 = std::move(t2);
+            t2 = std::move(t);
         }
 
         if (r1 != 1)
@@ -188,6 +337,352 @@ namespace cry
         return is_odd_impl<is_bigint<T>::value>()(arg);
     }
 
+    template <class Integer>
+    class montgomery_context;
+
+    /**
+     * \brief precomputed constants for Montgomery multiplication modulo a fixed odd modulus
+     * \tparam P limb type
+     */
+    template <class P>
+    class montgomery_context<basic_integer<P>>
+    {
+      public:
+        using integer_type = basic_integer<P>;
+
+      private:
+        using limbs_type     = typename integer_type::polynomial_type;
+        using workspace_type = small_vector<P, 2 * integer_type::inline_limbs + 1>;
+
+      public:
+        explicit montgomery_context(const integer_type& modulus) : m_N(modulus)
+        {
+            const auto& polynomial = modulus.polynomial();
+
+            auto first = polynomial.begin();
+            for (; first != polynomial.end() && *first == 0x00; ++first)
+                ;
+
+            m_Modulus.assign(first, polynomial.end());
+
+            if (m_Modulus.empty() || cry::is_even(modulus))
+            {
+                throw std::logic_error("montgomery modulus must be odd");
+            }
+
+            const size_t k = m_Modulus.size();
+
+            m_Inverse = Cry_montgomery_inverse(&m_Modulus[0], &m_Modulus[0] + k);
+
+            ///////////////////////////
+            // R^2 mod n, R = base^k
+            limbs_type r2(2 * k + 1);
+            r2[0] = 0x01;
+
+            m_R2 = limbs(integer_type(std::move(r2)) % m_N);
+        }
+
+        const integer_type& modulus() const noexcept
+        {
+            return m_N;
+        }
+
+        /**
+         * \brief converts a value to the Montgomery domain: x * R mod n
+         */
+        integer_type to_montgomery(const integer_type& x) const
+        {
+            workspace_type workspace(m_Modulus.size() + 2);
+            limbs_type out = reduced(x);
+
+            multiply(out, out, m_R2, workspace);
+
+            return integer_type(std::move(out));
+        }
+
+        /**
+         * \brief converts a value from the Montgomery domain: x * R^(-1) mod n
+         */
+        integer_type from_montgomery(const integer_type& x) const
+        {
+            workspace_type workspace(m_Modulus.size() + 2);
+            limbs_type out = reduced(x);
+
+            multiply(out, out, unit(), workspace);
+
+            return integer_type(std::move(out));
+        }
+
+        /**
+         * \brief Montgomery product of two values in the Montgomery domain: a * b * R^(-1) mod n
+         */
+        integer_type multiply(const integer_type& a, const integer_type& b) const
+        {
+            workspace_type workspace(m_Modulus.size() + 2);
+            limbs_type out = reduced(a);
+
+            multiply(out, out, reduced(b), workspace);
+
+            return integer_type(std::move(out));
+        }
+
+        /**
+         * \brief Montgomery square of a value in the Montgomery domain: a * a * R^(-1) mod n
+         */
+        integer_type square(const integer_type& a) const
+        {
+            workspace_type workspace(2 * m_Modulus.size() + 1);
+            limbs_type out = reduced(a);
+
+            square(out, out, workspace);
+
+            return integer_type(std::move(out));
+        }
+
+        /**
+         * \brief calculates arg^exp mod n
+         */
+        integer_type pow(const integer_type& arg, const integer_type& exp) const
+        {
+            const size_t k = m_Modulus.size();
+
+            workspace_type workspace(2 * k + 1);
+
+            limbs_type a = reduced(arg);
+            multiply(a, a, m_R2, workspace);
+
+            // 1 * R mod n
+            limbs_type one = unit();
+            multiply(one, one, m_R2, workspace);
+
+            auto y = sliding_window_pow(
+                a, exp, one, [this, &workspace](limbs_type& out, const limbs_type& lhs, const limbs_type& rhs) { multiply(out, lhs, rhs, workspace); },
+                [this, &workspace](limbs_type& out, const limbs_type& x) { square(out, x, workspace); });
+
+            multiply(y, y, unit(), workspace);
+
+            return integer_type(std::move(y));
+        }
+
+        /**
+         * \brief calculates arg^exp mod n for a single-word exponent such as 3, 17 or 65537
+         *
+         * Plain left-to-right square-and-multiply over the bits of exp: no window table and no
+         * bigint exponent, e = 65537 costs 16 squarings and one multiplication.
+         */
+        integer_type pow(const integer_type& arg, uint32_t exp) const
+        {
+            if (exp == 0)
+            {
+                return integer_type(1) % m_N;
+            }
+
+            workspace_type workspace(2 * m_Modulus.size() + 1);
+
+            limbs_type a = reduced(arg);
+            multiply(a, a, m_R2, workspace);
+
+            int top = 31;
+            for (; ((exp >> top) & 0x01) == 0x00; --top)
+                ;
+
+            limbs_type y = a;
+            for (int i = top - 1; i >= 0; --i)
+            {
+                square(y, y, workspace);
+
+                if ((exp >> i) & 0x01)
+                {
+                    multiply(y, y, a, workspace);
+                }
+            }
+
+            multiply(y, y, unit(), workspace);
+
+            return integer_type(std::move(y));
+        }
+
+      private:
+        void multiply(limbs_type& out, const limbs_type& a, const limbs_type& b, workspace_type& workspace) const
+        {
+            const size_t k = m_Modulus.size();
+
+            Cry_montgomery_multiply(&out[0] + k, &a[0], &a[0] + k, &b[0], &b[0] + k, &m_Modulus[0], &m_Modulus[0] + k, m_Inverse, &workspace[0]);
+        }
+
+        void square(limbs_type& out, const limbs_type& a, workspace_type& workspace) const
+        {
+            const size_t k = m_Modulus.size();
+
+            Cry_montgomery_square(&out[0] + k, &a[0], &a[0] + k, &m_Modulus[0], &m_Modulus[0] + k, m_Inverse, &workspace[0]);
+        }
+
+        limbs_type unit() const
+        {
+            limbs_type one(m_Modulus.size());
+            one.back() = 0x01;
+
+            return one;
+        }
+
+        limbs_type limbs(const integer_type& x) const
+        {
+            const auto& polynomial = x.polynomial();
+            const size_t k         = m_Modulus.size();
+
+            limbs_type out(k);
+
+            auto first = polynomial.begin();
+            if (polynomial.size() > k)
+            {
+                first += polynomial.size() - k;
+            }
+
+            std::copy_backward(first, polynomial.end(), out.end());
+
+            return out;
+        }
+
+        limbs_type reduced(const integer_type& x) const
+        {
+            if (x >= m_N)
+            {
+                return limbs(x % m_N);
+            }
+
+            return limbs(x);
+        }
+
+      private:
+        integer_type m_N;
+        limbs_type m_Modulus;
+        limbs_type m_R2;
+        P m_Inverse;
+    };
+
+    /**
+     * \brief repeated reduction modulo a fixed modulus, plain remainder for built-in integers
+     * \tparam Integer integer type
+     */
+    template <class Integer>
+    class barrett_context
+    {
+      public:
+        using integer_type = Integer;
+
+        explicit barrett_context(const integer_type& modulus) : m_N(modulus)
+        {
+        }
+
+        const integer_type& modulus() const noexcept
+        {
+            return m_N;
+        }
+
+        integer_type reduce(const integer_type& x) const
+        {
+            return x % m_N;
+        }
+
+      private:
+        integer_type m_N;
+    };
+
+    /**
+     * \brief Barrett reduction (HAC 14.42) with mu = floor(b^2k / m) precomputed for a fixed modulus m of k limbs
+     * \tparam P limb type
+     */
+    template <class P>
+    class barrett_context<basic_integer<P>>
+    {
+      public:
+        using integer_type = basic_integer<P>;
+
+        explicit barrett_context(const integer_type& modulus) : m_N(modulus)
+        {
+            if (!modulus || modulus < 0)
+            {
+                throw std::logic_error("barrett modulus must be positive");
+            }
+
+            m_K = (bit_length(modulus) + limb_bits - 1) / limb_bits;
+
+            ////////////////////////////////////////
+            // mu = floor(b^2k / m), b^(k + 1)
+            typename integer_type::polynomial_type b2k(2 * m_K + 1);
+            b2k[0] = 0x01;
+
+            m_Mu = integer_type(std::move(b2k)) / m_N;
+
+            typename integer_type::polynomial_type bk1(m_K + 2);
+            bk1[0] = 0x01;
+
+            m_Bk1 = integer_type(std::move(bk1));
+        }
+
+        const integer_type& modulus() const noexcept
+        {
+            return m_N;
+        }
+
+        /**
+         * \brief x mod m, values outside [0, b^2k) fall back to division
+         */
+        integer_type reduce(const integer_type& x) const
+        {
+            if (x < 0 || bit_length(x) > 2 * m_K * limb_bits)
+            {
+                return x % m_N;
+            }
+
+            // 1. q = floor(floor(x / b^(k - 1)) * mu / b^(k + 1))
+            integer_type q = x >> static_cast<int>((m_K - 1) * limb_bits);
+            q *= m_Mu;
+            q >>= static_cast<int>((m_K + 1) * limb_bits);
+
+            // 2. r = (x mod b^(k + 1)) - (q * m mod b^(k + 1))
+            integer_type r        = low_limbs(x, m_K + 1);
+            const integer_type qm = low_limbs(q * m_N, m_K + 1);
+
+            if (r < qm)
+            {
+                r += m_Bk1;
+            }
+
+            r -= qm;
+
+            // 3. at most two subtractions
+            while (r >= m_N)
+            {
+                r -= m_N;
+            }
+
+            return r;
+        }
+
+      private:
+        static integer_type low_limbs(const integer_type& x, size_t n)
+        {
+            const auto& polynomial = x.polynomial();
+
+            auto first = polynomial.begin();
+            if (polynomial.size() > n)
+            {
+                first += polynomial.size() - n;
+            }
+
+            return integer_type(first, polynomial.end());
+        }
+
+      private:
+        static constexpr size_t limb_bits = sizeof(P) * 8;
+
+        integer_type m_N;
+        integer_type m_Mu;
+        integer_type m_Bk1;
+        size_t m_K;
+    };
+
     /**
      * \brief
      * \tparam T
@@ -216,6 +711,71 @@ namespace cry
         return y;
     }
 
+    namespace
+    {
+        template <class T>
+        T pow_mod_binary(const T& arg, const T& exp, const T& mod)
+        {
+            T y = 1;
+            T a = arg;
+            T e = exp;
+
+            while (e > 0)
+            {
+                if (is_odd(e))
+                {
+                    y *= a;
+                    y %= mod;
+                }
+
+                a *= a;
+                a %= mod;
+
+                e >>= 1;
+            }
+
+            return y;
+        }
+
+        template <bool is_bigint>
+        struct pow_mod_impl;
+
+        template <>
+        struct pow_mod_impl<false>
+        {
+            template <class T>
+            T operator()(const T& arg, const T& exp, const T& mod) const
+            {
+                return pow_mod_binary(arg, exp, mod);
+            }
+        };
+
+        template <>
+        struct pow_mod_impl<true>
+        {
+            template <class T>
+            T operator()(const T& arg, const T& exp, const T& mod) const
+            {
+                if (cry::is_odd(mod))
+                {
+                    uint32_t word;
+                    if (to_word(exp, word))
+                    {
+                        return montgomery_context<T>(mod).pow(arg, word);
+                    }
+
+                    return montgomery_context<T>(mod).pow(arg, exp);
+                }
+
+                const barrett_context<T> barrett(mod);
+
+                return sliding_window_pow(
+                    barrett.reduce(arg), exp, T(1), [&barrett](T& out, const T& lhs, const T& rhs) { out = barrett.reduce(lhs * rhs); },
+                    [&barrett](T& out, const T& x) { out = barrett.reduce(x * x); });
+            }
+        };
+    }
+
     /**
      * \brief
      * \tparam T
@@ -227,25 +787,7 @@ namespace cry
     template <class T>
     T pow_mod(const T& arg, const T& exp, const T& mod)
     {
-        T y = 1;
-        T a = arg;
-        T e = exp;
-
-        while (e > 0)
-        {
-            if (is_odd(e))
-            {
-                y *= a;
-                y %= mod;
-            }
-
-            a *= a;
-            a %= mod;
-
-            e >>= 1;
-        }
-
-        return y;
+        return pow_mod_impl<is_bigint<T>::value>()(arg, exp, mod);
     }
 
     /**
@@ -275,6 +817,8 @@ namespace cry
 
         T a = 1;
 
+        const barrett_context<T> barrett(p);
+
     nexta:
         for (; t-- > 0;)
         {
@@ -288,7 +832,7 @@ namespace cry
 
             for (auto j = 1; j < v; ++j)
             {
-                b = pow_mod(b, T(2), p);
+                b = barrett.reduce(b * b);
                 if (b == 1)
                 {
                     return false;
@@ -377,7 +921,7 @@ namespace cry
         bool isDivisible = false;
 
         std::generate(std::begin(bytes), std::end(bytes), [&uid, &gen]() { return uid(gen); });
-        *bytes.begin() |= 0x80;
+        *bytes.begin() |= 0xC0; // top two bits, so that the product of two such primes has exactly 2 * nbits bits
         *(bytes.end() - 1) |= 0x01;
 
         T primeCandidate = OS2IP<T>()(bytes);
@@ -390,13 +934,9 @@ namespace cry
 
         for (auto p : primes2K)
         {
-            T rem = primeCandidate % p;
-
-            auto os = I2OSP<T>()(rem);
-            auto ip = OS2IP<uint32_t>()(os);
+            const uint32_t rem = primeCandidate.mod_word(p);
 
-            // auto rem = primeCandidate % prime;
-            remainders.push_back(/*rem*/ ip);
+            remainders.push_back(rem);
             if (rem == 0x00)
             {
                 isDivisible = true;
@@ -5,12 +5,18 @@
 #include <algorithm>
 #include <initializer_list>
 #include <sstream>
+#include <utility>
 #include <vector>
 
 #include <cctype>
 #include <cstdint>
 
 #include <cry_engine.hpp>
+#include <small_vector.hpp>
+
+#ifndef CRY_BIGINT_INLINE_BITS
+#define CRY_BIGINT_INLINE_BITS 4096
+#endif
 
 using namespace std;
 
@@ -73,6 +79,13 @@ namespace cry
     class basic_integer
     {
       public:
+        /**
+         * \brief limbs kept inline before the storage moves to the heap: CRY_BIGINT_INLINE_BITS plus two carry limbs
+         */
+        static constexpr size_t inline_limbs = CRY_BIGINT_INLINE_BITS / (sizeof(IntType) * 8) + 2;
+
+        using polynomial_type = small_vector<IntType, inline_limbs>;
+
         basic_integer() : m_Polynomial(1), m_Negative(false)
         {
         }
@@ -98,8 +111,22 @@ namespace cry
         {
         }
 
-        basic_integer(uint32_t x) : basic_integer({static_cast<IntType>((x & 0xff000000) >> 24), static_cast<IntType>((x & 0x00ff0000) >> 16), static_cast<IntType>((x & 0x0000ff00) >> 8), static_cast<IntType>(x & 0x000000ff)})
+        explicit basic_integer(polynomial_type polynomial, bool negative = false) : m_Polynomial(std::move(polynomial)), m_Negative(negative)
         {
+            normalize();
+        }
+
+        basic_integer(uint32_t x) : m_Polynomial((sizeof(uint32_t) + sizeof(IntType) - 1) / sizeof(IntType)), m_Negative(false)
+        {
+            uint64_t value = x;
+
+            for (auto it = m_Polynomial.rbegin(); it != m_Polynomial.rend(); ++it)
+            {
+                *it = static_cast<IntType>(value);
+
+                // two half-width shifts, a single shift by 64 bits is undefined for 64-bit limbs
+                value = (value >> (sizeof(IntType) * 4)) >> (sizeof(IntType) * 4);
+            }
         }
 
         basic_integer(const std::string& hex) : m_Polynomial(1), m_Negative(false)
@@ -151,7 +178,7 @@ namespace cry
 
                 // shift 4 to make space for new digit, and add the 4 bits of the new digit
                 // word = (word << 4) | (bt & 0xF);
-                word = (bt << cnt * 4) | (word);
+                word = static_cast<IntType>((static_cast<IntType>(bt) << cnt * 4) | word);
 
                 ++cnt;
 
@@ -175,12 +202,12 @@ namespace cry
 
             if (first != last)
             {
-                m_Polynomial = std::vector<IntType>(first, last);
+                m_Polynomial.assign(first, last);
                 m_Negative   = negative;
             }
         }
 
-        const std::vector<IntType>& polynomial() const
+        const polynomial_type& polynomial() const
         {
             return m_Polynomial;
         }
@@ -193,9 +220,9 @@ namespace cry
 
 		operator std::vector<uint8_t>() const;
 
-        const basic_integer operator<<(int) const;
+        basic_integer operator<<(int) const;
 
-        const basic_integer operator>>(int) const;
+        basic_integer operator>>(int) const;
 
         basic_integer& operator<<=(int nbits);
 
@@ -207,13 +234,13 @@ namespace cry
 
         basic_integer& operator+();
 
-        const basic_integer operator++(int);
+        basic_integer operator++(int);
 
-        const basic_integer operator--(int);
+        basic_integer operator--(int);
 
-        const basic_integer operator-() const;
+        basic_integer operator-() const;
 
-        const basic_integer operator~() const;
+        basic_integer operator~() const;
 
         basic_integer& operator+=(const basic_integer& rhs);
 
@@ -284,136 +311,160 @@ namespace cry
             return !(lhs == rhs);
         }
 
-        friend const basic_integer operator&(const basic_integer& lhs, const basic_integer& rhs)
+        friend basic_integer operator&(const basic_integer& lhs, const basic_integer& rhs)
         {
-            const auto& a = lhs.m_Polynomial;
-            const auto& b = rhs.m_Polynomial;
+            basic_integer temp(lhs);
 
-            auto max = std::max(a.size(), b.size());
+            temp &= rhs;
 
-            std::vector<IntType> out(max);
+            return temp;
+        }
 
-            Cry_and(&out[0] + out.size(), &a[0], &a[0] + a.size(), &b[0], &b[0] + b.size());
+        friend basic_integer operator&(basic_integer&& lhs, const basic_integer& rhs)
+        {
+            lhs &= rhs;
 
-            return basic_integer(out);
+            return std::move(lhs);
         }
 
-        friend const basic_integer operator|(const basic_integer& lhs, const basic_integer& rhs)
+        friend basic_integer operator&(const basic_integer& lhs, basic_integer&& rhs)
         {
-            const auto& a = lhs.m_Polynomial;
-            const auto& b = rhs.m_Polynomial;
+            rhs &= lhs;
 
-            auto max = std::max(a.size(), b.size());
+            return std::move(rhs);
+        }
 
-            std::vector<IntType> out(max);
+        friend basic_integer operator&(basic_integer&& lhs, basic_integer&& rhs)
+        {
+            lhs &= rhs;
 
-            Cry_or(&out[0] + out.size(), &a[0], &a[0] + a.size(), &b[0], &b[0] + b.size());
+            return std::move(lhs);
+        }
 
-            return basic_integer(out);
+        friend basic_integer operator|(const basic_integer& lhs, const basic_integer& rhs)
+        {
+            basic_integer temp(lhs);
+
+            temp |= rhs;
+
+            return temp;
         }
 
-        friend const basic_integer operator^(const basic_integer& lhs, const basic_integer& rhs)
+        friend basic_integer operator|(basic_integer&& lhs, const basic_integer& rhs)
         {
-            const auto& a = lhs.m_Polynomial;
-            const auto& b = rhs.m_Polynomial;
+            lhs |= rhs;
 
-            auto max = std::max(a.size(), b.size());
+            return std::move(lhs);
+        }
 
-            std::vector<IntType> out(max);
+        friend basic_integer operator|(const basic_integer& lhs, basic_integer&& rhs)
+        {
+            rhs |= lhs;
+
+            return std::move(rhs);
+        }
 
-            Cry_xor(&out[0] + out.size(), &lhs.m_Polynomial[0], &lhs.m_Polynomial[0] + lhs.m_Polynomial.size(), &rhs.m_Polynomial[0], &rhs.m_Polynomial[0] + rhs.m_Polynomial.size());
+        friend basic_integer operator|(basic_integer&& lhs, basic_integer&& rhs)
+        {
+            lhs |= rhs;
 
-            return basic_integer(out);
+            return std::move(lhs);
         }
 
-        friend const basic_integer operator+(const basic_integer& lhs, const basic_integer& rhs)
+        friend basic_integer operator^(const basic_integer& lhs, const basic_integer& rhs)
         {
-            const auto& a = lhs.m_Polynomial;
-            const auto& b = rhs.m_Polynomial;
+            basic_integer temp(lhs);
 
-            const size_t lsize = a.size();
-            const size_t rsize = b.size();
+            temp ^= rhs;
 
-            std::vector<IntType> out(std::max(lsize, rsize));
+            return temp;
+        }
 
-            // если знаки аргументов различны: (a)+(-b), (-a)+(b) ==> ?(a-b)
-            if (lhs.m_Negative ^ rhs.m_Negative)
-            {
-                const short cmp = Cry_compare(&a[0], &a[0] + lsize, &b[0], &b[0] + rsize);
+        friend basic_integer operator^(basic_integer&& lhs, const basic_integer& rhs)
+        {
+            lhs ^= rhs;
 
-                if (cmp == -1)
-                { // (|a| < |b|) ==> (|b| - |a|)
-                    Cry_subtract(&out[0] + out.size(), &b[0], &b[0] + rsize, &a[0], &a[0] + lsize);
+            return std::move(lhs);
+        }
 
-                    return basic_integer(out, rhs.m_Negative);
-                }
-                if (cmp == +1)
-                {
-                    // (|a| > |b|) ==> (|a| - |b|)
-                    Cry_subtract(&out[0] + out.size(), &a[0], &a[0] + lsize, &b[0], &b[0] + rsize);
+        friend basic_integer operator^(const basic_integer& lhs, basic_integer&& rhs)
+        {
+            rhs ^= lhs;
 
-                    return basic_integer(out, lhs.m_Negative);
-                }
-            }
-            else
-            { // если знаки аргументов одинаковы
-                Cry_add(&out[0] + out.size(), &a[0], &a[0] + lsize, &b[0], &b[0] + rsize);
+            return std::move(rhs);
+        }
 
-                return basic_integer<IntType>(out, lhs.m_Negative & rhs.m_Negative);
-            }
+        friend basic_integer operator^(basic_integer&& lhs, basic_integer&& rhs)
+        {
+            lhs ^= rhs;
 
-            return basic_integer();
+            return std::move(lhs);
         }
 
-        friend const basic_integer operator-(const basic_integer& lhs, const basic_integer& rhs)
+        friend basic_integer operator+(const basic_integer& lhs, const basic_integer& rhs)
         {
-            const auto& a = lhs.m_Polynomial;
-            const auto& b = rhs.m_Polynomial;
+            basic_integer temp(lhs);
 
-            const short cmp = Cry_compare(&a[0], &a[0] + a.size(), &b[0], &b[0] + b.size());
+            temp += rhs;
 
-            // если знаки аргументов различны: (a)-(-b), (-a)-(b) ==> ?(a+b)
-            if (lhs.m_Negative ^ rhs.m_Negative)
-            {
-                basic_integer temp((cmp == -1) ? rhs : lhs);
-                auto& out = temp.m_Polynomial;
+            return temp;
+        }
+
+        friend basic_integer operator+(basic_integer&& lhs, const basic_integer& rhs)
+        {
+            lhs += rhs;
 
-                Cry_add(&out[0] + out.size(), &a[0], &a[0] + a.size(), &b[0], &b[0] + b.size());
+            return std::move(lhs);
+        }
 
-                temp.m_Negative = lhs.m_Negative;
+        friend basic_integer operator+(const basic_integer& lhs, basic_integer&& rhs)
+        {
+            rhs += lhs;
 
-                return temp;
-            }
+            return std::move(rhs);
+        }
 
-            // если знаки аргументов одинаковы:
-            if (cmp == -1)
-            { // (|a| < |b|) ==> (|b| - |a|)
-                basic_integer temp(rhs);
-                auto& out = temp.m_Polynomial;
+        friend basic_integer operator+(basic_integer&& lhs, basic_integer&& rhs)
+        {
+            lhs += rhs;
+
+            return std::move(lhs);
+        }
 
-                Cry_subtract(&out[0] + out.size(), &b[0], &b[0] + b.size(), &a[0], &a[0] + a.size());
+        friend basic_integer operator-(const basic_integer& lhs, const basic_integer& rhs)
+        {
+            basic_integer temp(lhs);
 
-                temp.m_Negative = (!lhs.m_Negative & !rhs.m_Negative);
+            temp -= rhs;
 
-                return temp;
-            }
-            if (cmp == +1)
-            {
-                // (|a| > |b|) ==> (|a| - |b|)
-                basic_integer temp(lhs);
-                auto& out = temp.m_Polynomial;
+            return temp;
+        }
 
-                Cry_subtract(&out[0] + out.size(), &a[0], &a[0] + a.size(), &b[0], &b[0] + b.size());
+        friend basic_integer operator-(basic_integer&& lhs, const basic_integer& rhs)
+        {
+            lhs -= rhs;
 
-                temp.m_Negative = (lhs.m_Negative & rhs.m_Negative);
+            return std::move(lhs);
+        }
 
-                return temp;
-            }
+        friend basic_integer operator-(const basic_integer& lhs, basic_integer&& rhs)
+        {
+            // a - b == -(b - a)
+            rhs -= lhs;
+            rhs.m_Negative = !rhs.m_Negative;
+            rhs.normalize();
 
-            return basic_integer();
+            return std::move(rhs);
         }
 
-        friend const basic_integer operator*(const basic_integer& lhs, const basic_integer& rhs)
+        friend basic_integer operator-(basic_integer&& lhs, basic_integer&& rhs)
+        {
+            lhs -= rhs;
+
+            return std::move(lhs);
+        }
+
+        friend basic_integer operator*(const basic_integer& lhs, const basic_integer& rhs)
         {
             const auto& a = lhs.m_Polynomial;
             const auto& b = rhs.m_Polynomial;
@@ -421,14 +472,42 @@ namespace cry
             const size_t l_size = a.size();
             const size_t r_size = b.size();
 
-            std::vector<IntType> out(l_size + r_size);
+            polynomial_type out(l_size + r_size);
 
-            Cry_multiply(&out[0] + out.size(), &a[0], &a[0] + l_size, &b[0], &b[0] + r_size);
+            if (&lhs == &rhs || a == b)
+            {
+                Cry_square(&out[0] + out.size(), &a[0], &a[0] + l_size);
+            }
+            else
+            {
+                Cry_multiply(&out[0] + out.size(), &a[0], &a[0] + l_size, &b[0], &b[0] + r_size);
+            }
+
+            return basic_integer(std::move(out), lhs.m_Negative ^ rhs.m_Negative);
+        }
+
+        friend basic_integer operator*(basic_integer&& lhs, const basic_integer& rhs)
+        {
+            lhs *= rhs;
+
+            return std::move(lhs);
+        }
+
+        friend basic_integer operator*(const basic_integer& lhs, basic_integer&& rhs)
+        {
+            rhs *= lhs;
+
+            return std::move(rhs);
+        }
+
+        friend basic_integer operator*(basic_integer&& lhs, basic_integer&& rhs)
+        {
+            lhs *= rhs;
 
-            return basic_integer(out, lhs.m_Negative ^ rhs.m_Negative);
+            return std::move(lhs);
         }
 
-        friend const basic_integer operator/(const basic_integer& lhs, const basic_integer& rhs)
+        friend basic_integer operator/(const basic_integer& lhs, const basic_integer& rhs)
         {
             basic_integer div;
             basic_integer rem;
@@ -438,7 +517,14 @@ namespace cry
             return div;
         }
 
-        friend const basic_integer operator%(const basic_integer& lhs, const basic_integer& rhs)
+        friend basic_integer operator/(basic_integer&& lhs, const basic_integer& rhs)
+        {
+            lhs /= rhs;
+
+            return std::move(lhs);
+        }
+
+        friend basic_integer operator%(const basic_integer& lhs, const basic_integer& rhs)
         {
             basic_integer div;
             basic_integer rem;
@@ -448,8 +534,31 @@ namespace cry
             return rem;
         }
 
+        friend basic_integer operator%(basic_integer&& lhs, const basic_integer& rhs)
+        {
+            lhs %= rhs;
+
+            return std::move(lhs);
+        }
+
         void divide(basic_integer& q, basic_integer& r, const basic_integer& other) const;
 
+        /**
+         * \brief |*this| mod w in one pass over the limbs, without building a divisor integer
+         */
+        uint32_t mod_word(uint32_t w) const;
+
+        /**
+         * \brief reduces in place by the modulus of a precomputed context, e.g. cry::barrett_context
+         */
+        template <class Context>
+        basic_integer& reduce(const Context& ctx)
+        {
+            *this = ctx.reduce(*this);
+
+            return *this;
+        }
+
       protected:
         void __swap(basic_integer& other) noexcept
         {
@@ -461,13 +570,55 @@ namespace cry
         template <class X>
         friend short compare(const basic_integer<X>& lhs, const basic_integer<X>& rhs);
 
+        /**
+         * \brief strips leading zero limbs, zero is kept as a single non-negative limb
+         */
+        void normalize() noexcept
+        {
+            auto first = m_Polynomial.begin();
+            for (; first != m_Polynomial.end() && *first == 0x00; ++first)
+                ;
+
+            if (first == m_Polynomial.end())
+            {
+                m_Polynomial.resize(1);
+                m_Polynomial[0] = 0x00;
+                m_Negative      = false;
+                return;
+            }
+
+            m_Polynomial.erase(m_Polynomial.begin(), first);
+        }
+
+        /**
+         * \brief prepends zero limbs until the magnitude has at least nlimbs limbs
+         */
+        void grow(size_t nlimbs)
+        {
+            if (m_Polynomial.size() < nlimbs)
+            {
+                m_Polynomial.insert(m_Polynomial.begin(), nlimbs - m_Polynomial.size(), 0x00);
+            }
+        }
+
+        /**
+         * \brief *this += (rhs_negative ? -|rhs| : |rhs|) in place
+         */
+        void add_signed(const basic_integer& rhs, bool rhs_negative);
+
+        template <class Kernel>
+        void bitwise(const basic_integer& rhs, Kernel kernel);
+
       private:
-        std::vector<IntType> m_Polynomial;
+        polynomial_type m_Polynomial;
         bool m_Negative;
     };
 
     // =================================================================================
 
+    template <class X>
+    constexpr size_t basic_integer<X>::inline_limbs;
+
     template <class X>
     basic_integer<X>& basic_integer<X>::operator=(const basic_integer<X>& other)
     {
@@ -555,7 +706,7 @@ namespace cry
     }
 
     template <class X>
-    const basic_integer<X> basic_integer<X>::operator++(int)
+    basic_integer<X> basic_integer<X>::operator++(int)
     {
         basic_integer temp(*this);
 
@@ -565,7 +716,7 @@ namespace cry
     }
 
     template <class X>
-    const basic_integer<X> basic_integer<X>::operator--(int)
+    basic_integer<X> basic_integer<X>::operator--(int)
     {
         basic_integer temp(*this);
 
@@ -577,7 +728,7 @@ namespace cry
     template <class X>
     basic_integer<X>& basic_integer<X>::operator+=(const basic_integer<X>& rhs)
     {
-        *this = *this + rhs;
+        add_signed(rhs, rhs.m_Negative);
 
         return *this;
     }
@@ -585,11 +736,75 @@ namespace cry
     template <class X>
     basic_integer<X>& basic_integer<X>::operator-=(const basic_integer<X>& rhs)
     {
-        *this = *this - rhs;
+        add_signed(rhs, !rhs.m_Negative);
 
         return *this;
     }
 
+    template <class X>
+    void basic_integer<X>::add_signed(const basic_integer<X>& rhs, bool rhs_negative)
+    {
+        if (this == &rhs)
+        {
+            const basic_integer<X> copy(rhs);
+
+            add_signed(copy, rhs_negative);
+            return;
+        }
+
+        const auto& b = rhs.m_Polynomial;
+
+        // если знаки аргументов одинаковы: |a| + |b|, one more limb for the carry
+        if (m_Negative == rhs_negative)
+        {
+            grow(std::max(m_Polynomial.size(), b.size()) + 1);
+
+            auto& a = m_Polynomial;
+
+            Cry_add(&a[0] + a.size(), &a[0], &a[0] + a.size(), &b[0], &b[0] + b.size());
+        }
+        else
+        {
+            auto& a = m_Polynomial;
+
+            const short cmp = Cry_compare(&a[0], &a[0] + a.size(), &b[0], &b[0] + b.size());
+
+            if (cmp == -1)
+            { // (|a| < |b|) ==> (|b| - |a|)
+                grow(b.size());
+
+                Cry_subtract(&a[0] + a.size(), &b[0], &b[0] + b.size(), &a[0], &a[0] + a.size());
+
+                m_Negative = rhs_negative;
+            }
+            else
+            { // (|a| >= |b|) ==> (|a| - |b|)
+                Cry_subtract(&a[0] + a.size(), &a[0], &a[0] + a.size(), &b[0], &b[0] + b.size());
+            }
+        }
+
+        normalize();
+    }
+
+    template <class X>
+    template <class Kernel>
+    void basic_integer<X>::bitwise(const basic_integer<X>& rhs, Kernel kernel)
+    {
+        if (this != &rhs)
+        {
+            grow(rhs.m_Polynomial.size());
+        }
+
+        auto& a       = m_Polynomial;
+        const auto& b = rhs.m_Polynomial;
+
+        kernel(&a[0] + a.size(), &a[0], &a[0] + a.size(), &b[0], &b[0] + b.size());
+
+        m_Negative = false;
+
+        normalize();
+    }
+
     template <class X>
     basic_integer<X>& basic_integer<X>::operator+()
     {
@@ -597,13 +812,18 @@ namespace cry
     }
 
     template <class X>
-    const basic_integer<X> basic_integer<X>::operator-() const
+    basic_integer<X> basic_integer<X>::operator-() const
     {
-        return basic_integer(m_Polynomial, !m_Negative);
+        basic_integer temp(*this);
+
+        temp.m_Negative = !m_Negative;
+        temp.normalize();
+
+        return temp;
     }
 
     template <class X>
-    const basic_integer<X> basic_integer<X>::operator~() const
+    basic_integer<X> basic_integer<X>::operator~() const
     {
         basic_integer temp(*this);
 
@@ -617,7 +837,12 @@ namespace cry
     template <class X>
     basic_integer<X>& basic_integer<X>::operator%=(const basic_integer<X>& rhs)
     {
-        *this = *this % rhs;
+        basic_integer div;
+        basic_integer rem;
+
+        divide(div, rem, rhs);
+
+        *this = std::move(rem);
 
         return *this;
     }
@@ -625,7 +850,7 @@ namespace cry
     template <class X>
     basic_integer<X>& basic_integer<X>::operator&=(const basic_integer<X>& rhs)
     {
-        *this = *this & rhs;
+        bitwise(rhs, [](X* result, const X* first1, const X* last1, const X* first2, const X* last2) { Cry_and(result, first1, last1, first2, last2); });
 
         return *this;
     }
@@ -633,7 +858,7 @@ namespace cry
     template <class X>
     basic_integer<X>& basic_integer<X>::operator|=(const basic_integer<X>& rhs)
     {
-        *this = *this | rhs;
+        bitwise(rhs, [](X* result, const X* first1, const X* last1, const X* first2, const X* last2) { Cry_or(result, first1, last1, first2, last2); });
 
         return *this;
     }
@@ -641,7 +866,7 @@ namespace cry
     template <class X>
     basic_integer<X>& basic_integer<X>::operator^=(const basic_integer<X>& rhs)
     {
-        *this = *this ^ rhs;
+        bitwise(rhs, [](X* result, const X* first1, const X* last1, const X* first2, const X* last2) { Cry_xor(result, first1, last1, first2, last2); });
 
         return *this;
     }
@@ -649,7 +874,25 @@ namespace cry
     template <class X>
     basic_integer<X>& basic_integer<X>::operator*=(const basic_integer<X>& rhs)
     {
-        *this = *this * rhs;
+        const auto& a = m_Polynomial;
+        const auto& b = rhs.m_Polynomial;
+
+        Cry_scratch<X> out(a.size() + b.size());
+
+        if (this == &rhs || a == b)
+        {
+            Cry_square(&out[0] + out.size(), &a[0], &a[0] + a.size());
+        }
+        else
+        {
+            Cry_multiply(&out[0] + out.size(), &a[0], &a[0] + a.size(), &b[0], &b[0] + b.size());
+        }
+
+        // the product is written to scratch first, the existing buffer is reused when it is large enough
+        m_Polynomial.assign(out.begin(), out.end());
+        m_Negative = m_Negative != rhs.m_Negative;
+
+        normalize();
 
         return *this;
     }
@@ -657,7 +900,12 @@ namespace cry
     template <class X>
     basic_integer<X>& basic_integer<X>::operator/=(const basic_integer<X>& rhs)
     {
-        *this = *this / rhs;
+        basic_integer div;
+        basic_integer rem;
+
+        divide(div, rem, rhs);
+
+        *this = std::move(div);
 
         return *this;
     }
@@ -736,37 +984,47 @@ namespace cry
     }
 
     template <class T>
-    const basic_integer<T> basic_integer<T>::operator<<(int nbits) const
+    basic_integer<T> basic_integer<T>::operator<<(int nbits) const
     {
-        std::vector<T> out(m_Polynomial);
+        basic_integer<T> temp(*this);
 
-        Cry_lshift(&out[0], &out[0] + out.size(), nbits);
+        temp <<= nbits;
 
-        return basic_integer<T>(out);
+        return temp;
     }
 
     template <class T>
     basic_integer<T>& basic_integer<T>::operator<<=(int nbits)
     {
-        *this = *this << nbits;
+        if (nbits <= 0)
+        {
+            return *this;
+        }
+
+        ////////////////////////////////////////////////
+        // grow by enough limbs to hold the shifted-out bits
+        const size_t limb_bits = sizeof(T) * 8;
+        m_Polynomial.insert(m_Polynomial.begin(), (static_cast<size_t>(nbits) + limb_bits - 1) / limb_bits, 0x00);
+
+        Cry_lshift(&m_Polynomial[0], &m_Polynomial[0] + m_Polynomial.size(), nbits);
 
         return *this;
     }
 
     template <class T>
-    const basic_integer<T> basic_integer<T>::operator>>(int nbits) const
+    basic_integer<T> basic_integer<T>::operator>>(int nbits) const
     {
-        std::vector<T> out(m_Polynomial);
+        basic_integer<T> temp(*this);
 
-        Cry_rshift(&out[0], &out[0] + out.size(), nbits);
+        temp >>= nbits;
 
-        return basic_integer<T>(out);
+        return temp;
     }
 
     template <class T>
     basic_integer<T>& basic_integer<T>::operator>>=(int nbits)
     {
-        *this = *this >> nbits;
+        Cry_rshift(&m_Polynomial[0], &m_Polynomial[0] + m_Polynomial.size(), nbits);
 
         return *this;
     }
@@ -801,19 +1059,53 @@ namespace cry
 
         size_t l_size = a.size();
 
-        std::vector<T> v_div(l_size);
-        std::vector<T> v_rem(l_size);
+        Cry_scratch<T> v_div(l_size);
+        Cry_scratch<T> v_rem(l_size);
+        Cry_scratch<T> workspace(Cry_divide_workspace_size(a.size(), b.size()));
+
+        Cry_divide(&v_div[0] + v_div.size(), &v_rem[0] + v_rem.size(), &a[0], &a[0] + a.size(), &b[0], &b[0] + b.size(), &workspace[0]);
 
-        Cry_divide(&v_div[0] + v_div.size(), &v_rem[0] + v_rem.size(), &a[0], &a[0] + a.size(), &b[0], &b[0] + b.size());
+        const bool negative = this->m_Negative ^ other.m_Negative;
 
-        const basic_integer<T> div(v_div, this->m_Negative ^ other.m_Negative);
-        const basic_integer<T> rem(v_rem, this->m_Negative ^ other.m_Negative);
+        // q or r may alias *this or other
+        basic_integer<T> div(v_div.begin(), v_div.end(), negative);
+        basic_integer<T> rem(v_rem.begin(), v_rem.end(), negative);
 
-        q = div;
-        r = rem;
+        q = std::move(div);
+        r = std::move(rem);
+    }
+
+    template <class T>
+    uint32_t basic_integer<T>::mod_word(uint32_t w) const
+    {
+        if (w == 0)
+        {
+            throw std::runtime_error("division by zero");
+        }
+
+        const auto& a = m_Polynomial;
+
+        if (static_cast<uint64_t>(w) <= static_cast<T>(~static_cast<T>(0)))
+        {
+            return static_cast<uint32_t>(Cry_mod_word(&a[0], &a[0] + a.size(), static_cast<T>(w)));
+        }
+
+        // limbs narrower than w: 8 or 16 bit limbs keep the running remainder in 64 bits,
+        // two half-width shifts as a single one would overflow for the 64-bit limbs this is also compiled for
+        uint64_t r = 0x00;
+        for (const T limb : a)
+        {
+            r = (((r << (sizeof(T) * 4)) << (sizeof(T) * 4)) | limb) % w;
+        }
+
+        return static_cast<uint32_t>(r);
     }
 
     using bigint_t = basic_integer<uint32_t>;
+
+#if defined(__SIZEOF_INT128__)
+    using bigint64_t = basic_integer<uint64_t>;
+#endif
 }
 
 
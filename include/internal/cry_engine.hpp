@@ -2,6 +2,10 @@
 #ifndef CRY_CORE_HPP
 #define CRY_CORE_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
 #include <vector>
 
 namespace
@@ -29,6 +33,15 @@ namespace
         using wide_type             = uint64_t;
         static const wide_type base = static_cast<uint64_t>(UINT32_MAX) + 1;
     };
+
+#if defined(__SIZEOF_INT128__)
+    template <>
+    struct traits<uint64_t>
+    {
+        __extension__ typedef unsigned __int128 wide_type;
+        static const wide_type base = static_cast<wide_type>(UINT64_MAX) + 1;
+    };
+#endif
 }
 
 template <class T, class Traits = traits<T>>
@@ -91,13 +104,272 @@ void Cry_subtract(T* result, const T* first1, const T* last1, const T* first2, c
 
     for (; first1 <= last1; --last1)
     {
-        *(--result) = *(last1)-carry;
-        carry       = 0;
+        if (*(last1) < carry)
+        {
+            *(--result) = static_cast<T>((*last1) - carry + Traits::base);
+            carry       = 1;
+        }
+        else
+        {
+            *(--result) = static_cast<T>((*last1) - carry);
+            carry       = 0;
+        }
     }
 }
 
+#ifndef CRY_KARATSUBA_THRESHOLD
+#define CRY_KARATSUBA_THRESHOLD 32
+#endif
+
+#ifndef CRY_TOOM3_THRESHOLD
+#define CRY_TOOM3_THRESHOLD 128
+#endif
+
+// below two limbs the recursive splits never reach their base case
+static_assert(CRY_KARATSUBA_THRESHOLD >= 2, "CRY_KARATSUBA_THRESHOLD must be at least 2");
+static_assert(CRY_TOOM3_THRESHOLD >= 2, "CRY_TOOM3_THRESHOLD must be at least 2");
+
+// storage behind the getters and setters below, atomic because the cutoffs may be retuned while other threads multiply
+inline std::atomic<size_t>& Cry_karatsuba_threshold_value() noexcept
+{
+    static std::atomic<size_t> threshold{ CRY_KARATSUBA_THRESHOLD };
+
+    return threshold;
+}
+
+inline std::atomic<size_t>& Cry_toom3_threshold_value() noexcept
+{
+    static std::atomic<size_t> threshold{ CRY_TOOM3_THRESHOLD };
+
+    return threshold;
+}
+
+/**
+ * \brief operand length (in limbs) from which Cry_multiply switches from schoolbook to Karatsuba
+ */
+inline size_t Cry_karatsuba_threshold() noexcept
+{
+    return Cry_karatsuba_threshold_value().load(std::memory_order_relaxed);
+}
+
+/**
+ * \brief sets the Karatsuba cutoff, values below 2 are raised to 2; safe while other threads multiply
+ */
+inline void Cry_set_karatsuba_threshold(size_t nlimbs) noexcept
+{
+    Cry_karatsuba_threshold_value().store(std::max<size_t>(nlimbs, 2), std::memory_order_relaxed);
+}
+
+/**
+ * \brief operand length (in limbs) from which Cry_multiply switches from Karatsuba to Toom-3
+ */
+inline size_t Cry_toom3_threshold() noexcept
+{
+    return Cry_toom3_threshold_value().load(std::memory_order_relaxed);
+}
+
+/**
+ * \brief sets the Toom-3 cutoff, values below 2 are raised to 2; safe while other threads multiply
+ */
+inline void Cry_set_toom3_threshold(size_t nlimbs) noexcept
+{
+    Cry_toom3_threshold_value().store(std::max<size_t>(nlimbs, 2), std::memory_order_relaxed);
+}
+
+/**
+ * \brief fixed-size bump arena for kernel temporaries
+ *
+ * An arena is made current for the calling thread with Cry_scratch_scope. Kernel temporaries
+ * (Cry_scratch buffers) are then carved from it in stack order and fall back to the heap once it is exhausted.
+ */
+class Cry_scratch_arena
+{
+  public:
+    explicit Cry_scratch_arena(size_t nbytes) : m_Buffer(new unsigned char[nbytes]), m_Capacity(nbytes), m_Top(0)
+    {
+    }
+
+    Cry_scratch_arena(const Cry_scratch_arena&) = delete;
+
+    Cry_scratch_arena& operator=(const Cry_scratch_arena&) = delete;
+
+    /**
+     * \brief returns nullptr when the arena cannot hold nbytes more
+     */
+    void* allocate(size_t nbytes) noexcept
+    {
+        const size_t alignment = alignof(std::max_align_t);
+        const size_t offset    = (m_Top + alignment - 1) & ~(alignment - 1);
+
+        if (offset > m_Capacity || nbytes > m_Capacity - offset)
+        {
+            return nullptr;
+        }
+
+        m_Top = offset + nbytes;
+
+        return m_Buffer.get() + offset;
+    }
+
+    size_t mark() const noexcept
+    {
+        return m_Top;
+    }
+
+    void rewind(size_t mark) noexcept
+    {
+        m_Top = mark;
+    }
+
+    void reset() noexcept
+    {
+        m_Top = 0;
+    }
+
+    size_t used() const noexcept
+    {
+        return m_Top;
+    }
+
+    size_t capacity() const noexcept
+    {
+        return m_Capacity;
+    }
+
+    /**
+     * \brief arena of the calling thread, nullptr outside of a Cry_scratch_scope
+     */
+    static Cry_scratch_arena*& current() noexcept
+    {
+        static thread_local Cry_scratch_arena* arena = nullptr;
+
+        return arena;
+    }
+
+  private:
+    std::unique_ptr<unsigned char[]> m_Buffer;
+    size_t m_Capacity;
+    size_t m_Top;
+};
+
+/**
+ * \brief makes an arena current for the calling thread, everything carved from it inside the scope is released on exit
+ */
+class Cry_scratch_scope
+{
+  public:
+    explicit Cry_scratch_scope(Cry_scratch_arena& arena) noexcept : m_Arena(arena), m_Previous(Cry_scratch_arena::current()), m_Mark(arena.mark())
+    {
+        Cry_scratch_arena::current() = &m_Arena;
+    }
+
+    Cry_scratch_scope(const Cry_scratch_scope&) = delete;
+
+    Cry_scratch_scope& operator=(const Cry_scratch_scope&) = delete;
+
+    ~Cry_scratch_scope()
+    {
+        m_Arena.rewind(m_Mark);
+
+        Cry_scratch_arena::current() = m_Previous;
+    }
+
+  private:
+    Cry_scratch_arena& m_Arena;
+    Cry_scratch_arena* m_Previous;
+    size_t m_Mark;
+};
+
+/**
+ * \brief zero-initialized temporary limb buffer taken from the current scratch arena, or the heap without one
+ *
+ * Buffers are released in reverse order of construction, as locals are.
+ */
+template <class T>
+class Cry_scratch
+{
+  public:
+    explicit Cry_scratch(size_t n) : m_Arena(Cry_scratch_arena::current()), m_Mark(0), m_Data(nullptr), m_Size(n)
+    {
+        if (m_Arena != nullptr)
+        {
+            m_Mark = m_Arena->mark();
+            m_Data = static_cast<T*>(m_Arena->allocate(n * sizeof(T)));
+        }
+
+        if (m_Data == nullptr)
+        {
+            m_Arena = nullptr;
+            m_Heap.reset(new T[n]);
+            m_Data = m_Heap.get();
+        }
+
+        std::fill(m_Data, m_Data + n, 0x00);
+    }
+
+    Cry_scratch(const Cry_scratch&) = delete;
+
+    Cry_scratch& operator=(const Cry_scratch&) = delete;
+
+    ~Cry_scratch()
+    {
+        if (m_Arena != nullptr)
+        {
+            m_Arena->rewind(m_Mark);
+        }
+    }
+
+    size_t size() const noexcept
+    {
+        return m_Size;
+    }
+
+    T* begin() noexcept
+    {
+        return m_Data;
+    }
+
+    T* end() noexcept
+    {
+        return m_Data + m_Size;
+    }
+
+    const T* begin() const noexcept
+    {
+        return m_Data;
+    }
+
+    const T* end() const noexcept
+    {
+        return m_Data + m_Size;
+    }
+
+    T& operator[](size_t i) noexcept
+    {
+        return m_Data[i];
+    }
+
+    const T& operator[](size_t i) const noexcept
+    {
+        return m_Data[i];
+    }
+
+  private:
+    Cry_scratch_arena* m_Arena;
+    size_t m_Mark;
+    T* m_Data;
+    size_t m_Size;
+    std::unique_ptr<T[]> m_Heap;
+};
+
 template <class T, class Traits = traits<T>>
-void Cry_multiply(T* last_result, const T* first1, const T* last1, const T* first2, const T* last2)
+void Cry_multiply(T* last_result, const T* first1, const T* last1, const T* first2, const T* last2);
+
+/**
+ * \brief O(n^2) product, the result region of (last1 - first1) + (last2 - first2) limbs must be zeroed
+ */
+template <class T, class Traits = traits<T>>
+void Cry_multiply_schoolbook(T* last_result, const T* first1, const T* last1, const T* first2, const T* last2)
 {
     typedef typename Traits::wide_type wide_t;
 
@@ -151,6 +423,129 @@ void Cry_multiply(T* last_result, const T* first1, const T* last1, T x)
     *last_result = carry;
 }
 
+/**
+ * \brief calculates -n^(-1) mod 2^w for the least significant limb of an odd modulus (w = limb width)
+ */
+template <class T, class Traits = traits<T>>
+T Cry_montgomery_inverse(const T*, const T* last)
+{
+    typedef typename Traits::wide_type wide_t;
+
+    const wide_t n0 = *(--last);
+
+    // n0 * n0 == 1 (mod 8) for every odd n0, each Newton step doubles the number of correct bits
+    wide_t x = n0;
+
+    for (size_t nbits = 3; nbits < sizeof(T) * 8; nbits *= 2)
+    {
+        x = static_cast<T>(x * static_cast<T>(2 - n0 * x));
+    }
+
+    return static_cast<T>(0 - x);
+}
+
+/**
+ * \brief writes t - n if t >= n, otherwise t (t is a little-endian value of k + 1 limbs below 2n)
+ */
+template <class T, class Traits = traits<T>>
+void Cry_montgomery_finalize(T* last_result, const T* t, const T* first_mod, const T* last_mod)
+{
+    typedef typename Traits::wide_type wide_t;
+
+    const size_t nbits = sizeof(T) * 8;
+    const size_t k     = last_mod - first_mod;
+
+    bool subtract = (t[k] != 0x00);
+
+    for (size_t j = k; !subtract && j-- > 0;)
+    {
+        const T x = *(last_mod - 1 - j);
+        if (t[j] != x)
+        {
+            subtract = t[j] > x;
+            break;
+        }
+
+        if (j == 0)
+        {
+            subtract = true;
+        }
+    }
+
+    if (subtract)
+    {
+        wide_t borrow = 0x00;
+
+        for (size_t j = 0; j < k; ++j)
+        {
+            const wide_t tmp       = static_cast<wide_t>(static_cast<wide_t>(t[j]) - static_cast<wide_t>(*(last_mod - 1 - j)) - borrow);
+            *(last_result - 1 - j) = static_cast<T>(tmp);
+            borrow                 = (tmp >> nbits) ? 0x01 : 0x00;
+        }
+    }
+    else
+    {
+        std::reverse_copy(t, t + k, last_result - k);
+    }
+}
+
+/**
+ * \brief Montgomery product (CIOS): result = a * b * R^(-1) mod n, R = base^k
+ *
+ * Both operands must be reduced and have exactly k = (last_mod - first_mod) limbs,
+ * workspace must hold k + 2 limbs. The result may alias either operand.
+ */
+template <class T, class Traits = traits<T>>
+void Cry_montgomery_multiply(T* last_result, const T*, const T* last1, const T*, const T* last2, const T* first_mod, const T* last_mod, T inverse, T* workspace)
+{
+    typedef typename Traits::wide_type wide_t;
+
+    const size_t nbits = sizeof(T) * 8;
+    const size_t k     = last_mod - first_mod;
+
+    // little-endian accumulator
+    T* t = workspace;
+    std::fill(t, t + k + 2, 0x00);
+
+    for (size_t i = 0; i < k; ++i)
+    {
+        // t <-- t + a * b[i]
+        const wide_t b = *(last2 - 1 - i);
+        wide_t carry   = 0x00;
+        wide_t tmp     = 0x00;
+
+        for (size_t j = 0; j < k; ++j)
+        {
+            tmp   = static_cast<wide_t>(t[j]) + static_cast<wide_t>(*(last1 - 1 - j)) * b + carry;
+            t[j]  = static_cast<T>(tmp);
+            carry = tmp >> nbits;
+        }
+
+        tmp      = static_cast<wide_t>(t[k]) + carry;
+        t[k]     = static_cast<T>(tmp);
+        t[k + 1] = static_cast<T>(tmp >> nbits);
+
+        // t <-- (t + m * n) / base
+        const wide_t m = static_cast<T>(static_cast<wide_t>(t[0]) * inverse);
+
+        tmp   = static_cast<wide_t>(t[0]) + m * static_cast<wide_t>(*(last_mod - 1));
+        carry = tmp >> nbits;
+
+        for (size_t j = 1; j < k; ++j)
+        {
+            tmp      = static_cast<wide_t>(t[j]) + m * static_cast<wide_t>(*(last_mod - 1 - j)) + carry;
+            t[j - 1] = static_cast<T>(tmp);
+            carry    = tmp >> nbits;
+        }
+
+        tmp      = static_cast<wide_t>(t[k]) + carry;
+        t[k - 1] = static_cast<T>(tmp);
+        t[k]     = static_cast<T>(t[k + 1] + static_cast<T>(tmp >> nbits));
+    }
+
+    Cry_montgomery_finalize<T, Traits>(last_result, t, first_mod, last_mod);
+}
+
 template <class T, class Traits = traits<T>>
 short Cry_compare(const T* first1, const T* last1, const T* first2, const T* last2)
 {
@@ -207,94 +602,749 @@ bool Cry_equal(const T* first1, const T* last1, const T* first2, const T* last2)
     return (first1 == last1) && (first2 == last2);
 }
 
+namespace
+{
+    template <class T>
+    const T* Cry_skip_zeros(const T* first, const T* last)
+    {
+        for (; first != last && *first == 0x00; ++first)
+            ;
+
+        return first;
+    }
+
+    /**
+     * \brief adds [first, last) to the result region [first_result, last_result) shifted left by offset limbs
+     *
+     * The sum must fit into the result region.
+     */
+    template <class T, class Traits>
+    void Cry_add_shifted(T* first_result, T* last_result, size_t offset, const T* first, const T* last)
+    {
+        first = Cry_skip_zeros(first, last);
+        if (first != last)
+        {
+            Cry_add<T, Traits>(last_result - offset, first_result, last_result - offset, first, last);
+        }
+    }
+
+    template <class T>
+    struct Cry_signed
+    {
+        std::vector<T> magnitude;
+        bool negative;
+    };
+
+    template <class T, class Traits>
+    Cry_signed<T> Cry_signed_add(const Cry_signed<T>& x, const Cry_signed<T>& y)
+    {
+        const auto& a = x.magnitude;
+        const auto& b = y.magnitude;
+
+        if (x.negative == y.negative)
+        {
+            Cry_signed<T> out{std::vector<T>(std::max(a.size(), b.size()) + 1), x.negative};
+            Cry_add<T, Traits>(&out.magnitude[0] + out.magnitude.size(), &a[0], &a[0] + a.size(), &b[0], &b[0] + b.size());
+
+            return out;
+        }
+
+        if (Cry_compare<T, Traits>(&a[0], &a[0] + a.size(), &b[0], &b[0] + b.size()) >= 0)
+        {
+            Cry_signed<T> out{std::vector<T>(a.size()), x.negative};
+            Cry_subtract<T, Traits>(&out.magnitude[0] + out.magnitude.size(), &a[0], &a[0] + a.size(), Cry_skip_zeros(&b[0], &b[0] + b.size()), &b[0] + b.size());
+
+            return out;
+        }
+
+        Cry_signed<T> out{std::vector<T>(b.size()), y.negative};
+        Cry_subtract<T, Traits>(&out.magnitude[0] + out.magnitude.size(), &b[0], &b[0] + b.size(), Cry_skip_zeros(&a[0], &a[0] + a.size()), &a[0] + a.size());
+
+        return out;
+    }
+
+    template <class T, class Traits>
+    Cry_signed<T> Cry_signed_subtract(const Cry_signed<T>& x, const Cry_signed<T>& y)
+    {
+        return Cry_signed_add<T, Traits>(x, Cry_signed<T>{y.magnitude, !y.negative});
+    }
+
+    template <class T, class Traits>
+    Cry_signed<T> Cry_signed_multiply(const Cry_signed<T>& x, const Cry_signed<T>& y)
+    {
+        const auto& a = x.magnitude;
+        const auto& b = y.magnitude;
+
+        Cry_signed<T> out{std::vector<T>(a.size() + b.size()), x.negative != y.negative};
+        Cry_multiply<T, Traits>(&out.magnitude[0] + out.magnitude.size(), &a[0], &a[0] + a.size(), &b[0], &b[0] + b.size());
+
+        return out;
+    }
+
+    /**
+     * \brief exact division of the magnitude by a single limb
+     */
+    template <class T, class Traits>
+    Cry_signed<T> Cry_signed_divide(Cry_signed<T> x, T divisor)
+    {
+        typedef typename Traits::wide_type wide_t;
+
+        wide_t rem = 0x00;
+        for (auto& limb : x.magnitude)
+        {
+            const wide_t cur = (rem << (sizeof(T) * 8)) | limb;
+
+            limb = static_cast<T>(cur / divisor);
+            rem  = cur % divisor;
+        }
+
+        return x;
+    }
+
+    /**
+     * \brief Karatsuba product, requires len1 >= len2 > len1 / 2, the result region must be zeroed
+     */
+    template <class T, class Traits>
+    void Cry_multiply_karatsuba(T* last_result, const T* first1, const T* last1, const T* first2, const T* last2)
+    {
+        const size_t len1 = last1 - first1;
+        const size_t len2 = last2 - first2;
+        const size_t h    = len1 / 2;
+
+        T* first_result = last_result - (len1 + len2);
+
+        //////////////////////////////////////////
+        // a = a1 * base^h + a0, b = b1 * base^h + b0
+        const T* mid1 = last1 - h;
+        const T* mid2 = last2 - h;
+
+        ////////////////////////////////////////////////////
+        // z0 = a0 * b0 and z2 = a1 * b1 go straight into the result
+        Cry_multiply<T, Traits>(last_result, mid1, last1, mid2, last2);
+        Cry_multiply<T, Traits>(last_result - 2 * h, first1, mid1, first2, mid2);
+
+        /////////////////////////////////////////
+        // z1 = (a0 + a1) * (b0 + b1) - z0 - z2
+        Cry_scratch<T> sa(std::max<size_t>(h, len1 - h) + 1);
+        Cry_scratch<T> sb(std::max<size_t>(h, len2 - h) + 1);
+
+        Cry_add<T, Traits>(&sa[0] + sa.size(), mid1, last1, first1, mid1);
+        Cry_add<T, Traits>(&sb[0] + sb.size(), mid2, last2, first2, mid2);
+
+        Cry_scratch<T> z1(sa.size() + sb.size());
+        Cry_multiply<T, Traits>(&z1[0] + z1.size(), &sa[0], &sa[0] + sa.size(), &sb[0], &sb[0] + sb.size());
+
+        T* z1_last = &z1[0] + z1.size();
+
+        Cry_subtract<T, Traits>(z1_last, &z1[0], z1_last, Cry_skip_zeros<T>(last_result - 2 * h, last_result), last_result);
+        Cry_subtract<T, Traits>(z1_last, &z1[0], z1_last, Cry_skip_zeros<T>(first_result, last_result - 2 * h), last_result - 2 * h);
+
+        Cry_add_shifted<T, Traits>(first_result, last_result, h, &z1[0], z1_last);
+    }
+
+    /**
+     * \brief Toom-3 product (evaluation points 0, 1, -1, -2, inf), requires len1 >= len2 > 2 * len1 / 3,
+     * the result region must be zeroed
+     */
+    template <class T, class Traits>
+    void Cry_multiply_toom3(T* last_result, const T* first1, const T* last1, const T* first2, const T* last2)
+    {
+        const size_t len1 = last1 - first1;
+        const size_t len2 = last2 - first2;
+        const size_t k    = (len1 + 2) / 3;
+
+        T* first_result = last_result - (len1 + len2);
+
+        auto piece = [k](const T* first, const T* last, size_t i) {
+            const size_t len = last - first;
+
+            const T* hi = last - std::min(len, i * k);
+            const T* lo = last - std::min(len, (i + 1) * k);
+
+            if (lo == hi)
+            {
+                return Cry_signed<T>{std::vector<T>(1), false};
+            }
+
+            return Cry_signed<T>{std::vector<T>(lo, hi), false};
+        };
+
+        const auto a0 = piece(first1, last1, 0), a1 = piece(first1, last1, 1), a2 = piece(first1, last1, 2);
+        const auto b0 = piece(first2, last2, 0), b1 = piece(first2, last2, 1), b2 = piece(first2, last2, 2);
+
+        auto add      = Cry_signed_add<T, Traits>;
+        auto subtract = Cry_signed_subtract<T, Traits>;
+        auto multiply = Cry_signed_multiply<T, Traits>;
+        auto divide   = Cry_signed_divide<T, Traits>;
+
+        ////////////////
+        // evaluation
+        const auto pa   = add(a0, a2);
+        const auto pa1  = add(pa, a1);
+        const auto pam1 = subtract(pa, a1);
+        const auto qa   = add(pam1, a2);
+        const auto pam2 = subtract(add(qa, qa), a0);
+
+        const auto pb   = add(b0, b2);
+        const auto pb1  = add(pb, b1);
+        const auto pbm1 = subtract(pb, b1);
+        const auto qb   = add(pbm1, b2);
+        const auto pbm2 = subtract(add(qb, qb), b0);
+
+        ////////////////////
+        // pointwise products
+        const auto r0   = multiply(a0, b0);
+        const auto r1   = multiply(pa1, pb1);
+        const auto rm1  = multiply(pam1, pbm1);
+        const auto rm2  = multiply(pam2, pbm2);
+        const auto rinf = multiply(a2, b2);
+
+        //////////////////////////////
+        // interpolation (Bodrato)
+        auto t3 = divide(subtract(rm2, r1), 3);
+        auto t1 = divide(subtract(r1, rm1), 2);
+        auto t2 = subtract(rm1, r0);
+
+        t3 = add(divide(subtract(t2, t3), 2), add(rinf, rinf));
+        t2 = subtract(add(t2, t1), rinf);
+        t1 = subtract(t1, t3);
+
+        //////////////////////////////////////////////////////////////////////
+        // result = r0 + t1 * base^k + t2 * base^2k + t3 * base^3k + rinf * base^4k
+        const Cry_signed<T>* coefficients[] = {&r0, &t1, &t2, &t3, &rinf};
+
+        for (size_t i = 0; i < 5; ++i)
+        {
+            const auto& c = coefficients[i]->magnitude;
+
+            Cry_add_shifted<T, Traits>(first_result, last_result, i * k, &c[0], &c[0] + c.size());
+        }
+    }
+}
+
+/**
+ * \brief multiplies two numbers, the result region of (last1 - first1) + (last2 - first2) limbs is overwritten
+ *
+ * Operands shorter than Cry_karatsuba_threshold() limbs use the schoolbook method, longer balanced
+ * operands are split recursively with Karatsuba or, from Cry_toom3_threshold() limbs, with Toom-3.
+ */
+template <class T, class Traits>
+void Cry_multiply(T* last_result, const T* first1, const T* last1, const T* first2, const T* last2)
+{
+    std::fill(last_result - (last1 - first1) - (last2 - first2), last_result, 0x00);
+
+    first1 = Cry_skip_zeros(first1, last1);
+    first2 = Cry_skip_zeros(first2, last2);
+
+    if (last1 - first1 < last2 - first2)
+    {
+        std::swap(first1, first2);
+        std::swap(last1, last2);
+    }
+
+    const size_t len1 = last1 - first1;
+    const size_t len2 = last2 - first2;
+
+    if (len2 == 0)
+    {
+        return;
+    }
+
+    if (len2 < Cry_karatsuba_threshold())
+    {
+        Cry_multiply_schoolbook<T, Traits>(last_result, first1, last1, first2, last2);
+    }
+    else if (2 * len2 <= len1)
+    {
+        ////////////////////////////////////////////////////////////////////
+        // unbalanced operands: multiply b by len2-limb slices of a
+        T* first_result = last_result - (len1 + len2);
+
+        Cry_scratch<T> partial(2 * len2);
+
+        for (size_t offset = 0; offset < len1; offset += len2)
+        {
+            const T* hi = last1 - offset;
+            const T* lo = hi - std::min(len2, len1 - offset);
+
+            T* partial_last = &partial[0] + (hi - lo) + len2;
+
+            Cry_multiply<T, Traits>(partial_last, lo, hi, first2, last2);
+
+            Cry_add_shifted<T, Traits>(first_result, last_result, offset, &partial[0], partial_last);
+        }
+    }
+    else if (len2 >= Cry_toom3_threshold() && 3 * len2 > 2 * len1)
+    {
+        Cry_multiply_toom3<T, Traits>(last_result, first1, last1, first2, last2);
+    }
+    else
+    {
+        Cry_multiply_karatsuba<T, Traits>(last_result, first1, last1, first2, last2);
+    }
+}
+
 template <class T, class Traits = traits<T>>
-void Cry_divide(T* div_last, T* rem_last, const T* first1, const T* last1, const T* first2, const T* last2)
+void Cry_square(T* last_result, const T* first, const T* last);
+
+/**
+ * \brief O(n^2) square computing each cross product once, the result region of 2 * (last - first) limbs must be zeroed
+ */
+template <class T, class Traits = traits<T>>
+void Cry_square_schoolbook(T* last_result, const T* first, const T* last)
 {
     typedef typename Traits::wide_type wide_t;
 
-    while ((first1 != last1) && (*first1 == 0x00))
+    const size_t nbits = sizeof(T) * 8;
+    const size_t n     = last - first;
+
+    T* const result = last_result - 1;
+
+    //////////////////////////////////////
+    // cross products a[i] * a[j], i < j
+    for (size_t i = 0; i + 1 < n; ++i)
     {
-        ++first1;
+        const wide_t x = *(last - 1 - i);
+        wide_t carry   = 0x00;
+
+        for (size_t j = i + 1; j < n; ++j)
+        {
+            const wide_t tmp   = static_cast<wide_t>(*(result - i - j)) + x * static_cast<wide_t>(*(last - 1 - j)) + carry;
+            *(result - i - j) = static_cast<T>(tmp);
+            carry              = tmp >> nbits;
+        }
+
+        *(result - i - n) = static_cast<T>(carry);
     }
 
-    while ((first2 != last2) && (*first2 == 0x00))
+    //////////////////////
+    // doubling
+    T carry = 0x00;
+
+    for (size_t i = 0; i < 2 * n; ++i)
     {
-        ++first2;
+        const T x       = *(result - i);
+        *(result - i) = static_cast<T>((x << 1) | carry);
+        carry           = static_cast<T>(x >> (nbits - 1));
     }
 
-    auto rTmp = std::vector<T>(first1, last1);
+    ///////////////////////////////
+    // diagonal squares a[i] * a[i]
+    wide_t c = 0x00;
 
-    auto d1         = last1 - first1;
-    auto d2         = last2 - first2;
-    auto shift      = d1 - d2 + 1;
-    T* rFirst       = &rTmp[0];
-    T* rLast        = rFirst + d2;
-    const T* dFirst = first2;
-    const T* dLast  = last2;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const wide_t x  = *(last - 1 - i);
+        const wide_t sq = x * x;
+
+        wide_t tmp         = static_cast<wide_t>(*(result - 2 * i)) + static_cast<T>(sq) + c;
+        *(result - 2 * i) = static_cast<T>(tmp);
+        c                  = tmp >> nbits;
+
+        tmp                    = static_cast<wide_t>(*(result - 2 * i - 1)) + (sq >> nbits) + c;
+        *(result - 2 * i - 1) = static_cast<T>(tmp);
+        c                      = tmp >> nbits;
+    }
+}
 
-    std::advance(div_last, -shift);
+namespace
+{
+    /**
+     * \brief Karatsuba square, the result region must be zeroed
+     */
+    template <class T, class Traits>
+    void Cry_square_karatsuba(T* last_result, const T* first, const T* last)
+    {
+        const size_t n = last - first;
+        const size_t h = n / 2;
 
-    auto cmp = Cry_compare<T>(rFirst, rLast, dFirst, dLast);
-    if (cmp == -1)
+        T* first_result = last_result - 2 * n;
+        const T* mid    = last - h;
+
+        ////////////////////////////////////////////////////////////
+        // z0 = a0^2 and z2 = a1^2 go straight into the result
+        Cry_square<T, Traits>(last_result, mid, last);
+        Cry_square<T, Traits>(last_result - 2 * h, first, mid);
+
+        ///////////////////////////////////
+        // z1 = (a0 + a1)^2 - z0 - z2
+        Cry_scratch<T> sa(std::max<size_t>(h, n - h) + 1);
+        Cry_add<T, Traits>(&sa[0] + sa.size(), mid, last, first, mid);
+
+        Cry_scratch<T> z1(2 * sa.size());
+        Cry_square<T, Traits>(&z1[0] + z1.size(), &sa[0], &sa[0] + sa.size());
+
+        T* z1_last = &z1[0] + z1.size();
+
+        Cry_subtract<T, Traits>(z1_last, &z1[0], z1_last, Cry_skip_zeros<T>(last_result - 2 * h, last_result), last_result);
+        Cry_subtract<T, Traits>(z1_last, &z1[0], z1_last, Cry_skip_zeros<T>(first_result, last_result - 2 * h), last_result - 2 * h);
+
+        Cry_add_shifted<T, Traits>(first_result, last_result, h, &z1[0], z1_last);
+    }
+}
+
+/**
+ * \brief squares a number, the result region of 2 * (last - first) limbs is overwritten
+ */
+template <class T, class Traits>
+void Cry_square(T* last_result, const T* first, const T* last)
+{
+    std::fill(last_result - 2 * (last - first), last_result, 0x00);
+
+    first = Cry_skip_zeros(first, last);
+
+    const size_t n = last - first;
+
+    if (n == 0)
+    {
+        return;
+    }
+
+    if (n < Cry_karatsuba_threshold())
+    {
+        Cry_square_schoolbook<T, Traits>(last_result, first, last);
+    }
+    else if (n >= Cry_toom3_threshold())
+    {
+        Cry_multiply_toom3<T, Traits>(last_result, first, last, first, last);
+    }
+    else
     {
-        ++rLast;
-        ++div_last;
-        --shift;
+        Cry_square_karatsuba<T, Traits>(last_result, first, last);
     }
+}
+
+/**
+ * \brief Montgomery square: result = a * a * R^(-1) mod n, R = base^k
+ *
+ * The operand must be reduced and have exactly k = (last_mod - first_mod) limbs,
+ * workspace must hold 2k + 1 limbs. The result may alias the operand.
+ */
+template <class T, class Traits = traits<T>>
+void Cry_montgomery_square(T* last_result, const T* first, const T* last, const T* first_mod, const T* last_mod, T inverse, T* workspace)
+{
+    typedef typename Traits::wide_type wide_t;
+
+    const size_t nbits = sizeof(T) * 8;
+    const size_t k     = last_mod - first_mod;
 
-    size_t nbytes = d2 + 1;
-    std::vector<T> mul(nbytes);
+    // little-endian accumulator
+    T* t = workspace;
 
-    while (shift > 0)
+    Cry_square<T, Traits>(t + 2 * k, first, last);
+    std::reverse(t, t + 2 * k);
+    t[2 * k] = 0x00;
+
+    // t <-- (t + m * n) / R
+    for (size_t i = 0; i < k; ++i)
     {
-        T Down    = 0x00;
-        wide_t Up = Traits::base;
+        const wide_t m = static_cast<T>(static_cast<wide_t>(t[i]) * inverse);
+        wide_t carry   = 0x00;
 
-        cmp = Cry_compare<T>(rFirst, rLast, dFirst, dLast);
-        if (cmp == -1)
+        for (size_t j = 0; j < k; ++j)
         {
-            ++rLast;
+            const wide_t tmp = static_cast<wide_t>(t[i + j]) + m * static_cast<wide_t>(*(last_mod - 1 - j)) + carry;
+            t[i + j]         = static_cast<T>(tmp);
+            carry            = tmp >> nbits;
         }
 
-        for (; Down < Up - 1;)
+        for (size_t j = i + k; carry != 0x00; ++j)
         {
-            // 1. c <-- (down + up) / 2;
-            T Middle = static_cast<T>(((Down + Up) / 2));
+            const wide_t tmp = static_cast<wide_t>(t[j]) + carry;
+            t[j]             = static_cast<T>(tmp);
+            carry            = tmp >> nbits;
+        }
+    }
 
-            // 2. mul <-- d * c;
-            std::fill(&mul[0], &mul[0] + nbytes, 0x00);
+    Cry_montgomery_finalize<T, Traits>(last_result, t + k, first_mod, last_mod);
+}
 
-            Cry_multiply(&mul[0] + nbytes, dFirst, dLast, Middle);
+/**
+ * \brief single-limb divisor with its precomputed reciprocal, see Cry_make_word_divisor
+ */
+template <class T>
+struct Cry_word_divisor
+{
+    T d;          // the divisor shifted left until its top bit is set
+    T reciprocal; // floor((base^2 - 1) / d) - base
+    int shift;
+};
+
+/**
+ * \brief normalizes a non-zero divisor and computes its reciprocal, so every limb divided by it
+ * costs two multiplications instead of a wide division (Moller, Granlund: "Improved division by invariant integers")
+ */
+template <class T, class Traits = traits<T>>
+Cry_word_divisor<T> Cry_make_word_divisor(T d)
+{
+    typedef typename Traits::wide_type wide_t;
 
-            const short mulCmp = Cry_compare(&mul[0], &mul[0] + nbytes, rFirst, rLast);
+    const size_t nbits = sizeof(T) * 8;
 
-            if (mulCmp == -1)
-            { // if(c < a): down <-- c
-                Down = Middle;
-            }
-            else if (mulCmp == 1)
-            { // if(c > a) Up <-- c
-                Up = Middle;
-            }
-            else if (mulCmp == 0)
-            { // if(mul == a) Up <-- C; Down <-- Up;
-                Up   = Middle;
-                Down = static_cast<T>(Up);
+    int shift = 0;
+    for (; (d & (static_cast<T>(1) << (nbits - 1))) == 0x00; d = static_cast<T>(d << 1))
+    {
+        ++shift;
+    }
+
+    const wide_t max = static_cast<wide_t>(~static_cast<wide_t>(0));
+
+    return Cry_word_divisor<T>{ d, static_cast<T>(max / d - Traits::base), shift };
+}
+
+/**
+ * \brief divides the two limbs u1:u0 by the normalized divisor, u1 must be less than divisor.d
+ * \return quotient, the remainder goes to r
+ */
+template <class T, class Traits = traits<T>>
+T Cry_divide_2by1(T u1, T u0, const Cry_word_divisor<T>& divisor, T& r)
+{
+    typedef typename Traits::wide_type wide_t;
+
+    const size_t nbits = sizeof(T) * 8;
+
+    const wide_t q = static_cast<wide_t>(divisor.reciprocal) * u1 + ((static_cast<wide_t>(u1) << nbits) | u0);
+
+    T q1       = static_cast<T>((q >> nbits) + 1);
+    const T q0 = static_cast<T>(q);
+
+    r = static_cast<T>(u0 - q1 * divisor.d);
+
+    // at most two corrections
+    if (r > q0)
+    {
+        q1 = static_cast<T>(q1 - 1);
+        r  = static_cast<T>(r + divisor.d);
+    }
+
+    if (r >= divisor.d)
+    {
+        q1 = static_cast<T>(q1 + 1);
+        r  = static_cast<T>(r - divisor.d);
+    }
+
+    return q1;
+}
+
+/**
+ * \brief divides [first, last) by a single limb in one pass
+ *
+ * Writes the (last - first) quotient limbs backward from div_last.
+ * \return remainder
+ */
+template <class T, class Traits = traits<T>>
+T Cry_divmod_word(T* div_last, const T* first, const T* last, const Cry_word_divisor<T>& divisor)
+{
+    const size_t nbits = sizeof(T) * 8;
+    const int s        = divisor.shift;
+
+    T* div = div_last - (last - first);
+
+    // the dividend is shifted along with the divisor, limb i of it is first[i] << s | first[i + 1] >> (nbits - s)
+    T r = (s != 0 && first != last) ? static_cast<T>(*first >> (nbits - s)) : static_cast<T>(0x00);
+
+    for (; first != last; ++first)
+    {
+        T u = static_cast<T>(*first << s);
+        if (s != 0 && first + 1 != last)
+        {
+            u = static_cast<T>(u | (*(first + 1) >> (nbits - s)));
+        }
+
+        *div++ = Cry_divide_2by1<T, Traits>(r, u, divisor, r);
+    }
+
+    return static_cast<T>(r >> s);
+}
+
+/**
+ * \brief remainder of [first, last) modulo a single limb in one pass, see Cry_divmod_word
+ */
+template <class T, class Traits = traits<T>>
+T Cry_mod_word(const T* first, const T* last, const Cry_word_divisor<T>& divisor)
+{
+    const size_t nbits = sizeof(T) * 8;
+    const int s        = divisor.shift;
+
+    T r = (s != 0 && first != last) ? static_cast<T>(*first >> (nbits - s)) : static_cast<T>(0x00);
+
+    for (; first != last; ++first)
+    {
+        T u = static_cast<T>(*first << s);
+        if (s != 0 && first + 1 != last)
+        {
+            u = static_cast<T>(u | (*(first + 1) >> (nbits - s)));
+        }
+
+        Cry_divide_2by1<T, Traits>(r, u, divisor, r);
+    }
+
+    return static_cast<T>(r >> s);
+}
+
+/**
+ * \brief remainder of [first, last) modulo a single non-zero limb d
+ */
+template <class T, class Traits = traits<T>>
+T Cry_mod_word(const T* first, const T* last, T d)
+{
+    return Cry_mod_word<T, Traits>(first, last, Cry_make_word_divisor<T, Traits>(d));
+}
+
+/**
+ * \brief number of scratch limbs Cry_divide needs for a dividend of n1 and a divisor of n2 limbs
+ */
+inline size_t Cry_divide_workspace_size(size_t n1, size_t n2) noexcept
+{
+    return n1 + n2 + 1;
+}
+
+/**
+ * \brief divides two numbers with Knuth's Algorithm D (TAOCP vol. 2, 4.3.1)
+ *
+ * Writes the (last1 - first1) - (last2 - first2) + 1 quotient limbs backward from div_last
+ * and the (last2 - first2) remainder limbs backward from rem_last. The divisor must be non-zero,
+ * workspace must hold Cry_divide_workspace_size(last1 - first1, last2 - first2) limbs.
+ */
+template <class T, class Traits = traits<T>>
+void Cry_divide(T* div_last, T* rem_last, const T* first1, const T* last1, const T* first2, const T* last2, T* workspace)
+{
+    typedef typename Traits::wide_type wide_t;
+
+    const size_t nbits = sizeof(T) * 8;
+
+    first1 = Cry_skip_zeros(first1, last1);
+    first2 = Cry_skip_zeros(first2, last2);
+
+    const size_t d1 = last1 - first1;
+    const size_t n  = last2 - first2;
+
+    if (d1 < n)
+    {
+        std::copy_backward(first1, last1, rem_last);
+        return;
+    }
+
+    const size_t m = d1 - n;
+
+    ////////////////////////////////////////////
+    // single limb divisor: short division
+    if (n == 1)
+    {
+        *(rem_last - 1) = Cry_divmod_word<T, Traits>(div_last, first1, last1, Cry_make_word_divisor<T, Traits>(*first2));
+        return;
+    }
+
+    ///////////////////////////////////////////////////////////////////
+    // 1. normalize: shift so that the top divisor limb has its high bit set,
+    //    u and v are little-endian copies in the workspace
+    T* u = workspace;
+    T* v = workspace + d1 + 1;
+
+    size_t s = 0;
+    for (T top = *first2; (top & (static_cast<T>(1) << (nbits - 1))) == 0x00; top = static_cast<T>(top << 1))
+    {
+        ++s;
+    }
+
+    T carry = 0x00;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const wide_t w = static_cast<wide_t>(*(last2 - 1 - i)) << s;
+        v[i]           = static_cast<T>(w) | carry;
+        carry          = static_cast<T>(w >> nbits);
+    }
+
+    carry = 0x00;
+    for (size_t i = 0; i < d1; ++i)
+    {
+        const wide_t w = static_cast<wide_t>(*(last1 - 1 - i)) << s;
+        u[i]           = static_cast<T>(w) | carry;
+        carry          = static_cast<T>(w >> nbits);
+    }
+    u[d1] = carry;
+
+    const wide_t base = Traits::base;
+    const wide_t v1   = v[n - 1];
+    const wide_t v2   = v[n - 2];
+
+    for (size_t j = m + 1; j-- > 0;)
+    {
+        ///////////////////////////////////////////////////////////
+        // 2. estimate q from the top two limbs, at most two corrections
+        const wide_t num = (static_cast<wide_t>(u[j + n]) << nbits) | u[j + n - 1];
+
+        wide_t qhat = num / v1;
+        wide_t rhat = num % v1;
+
+        while (qhat >= base || qhat * v2 > ((rhat << nbits) | u[j + n - 2]))
+        {
+            --qhat;
+            rhat += v1;
+
+            if (rhat >= base)
+            {
+                break;
             }
         }
 
-        std::fill(&mul[0], &mul[0] + nbytes, 0x00);
+        ///////////////////////////////
+        // 3. u[j, j + n] -= q * v
+        wide_t mul_carry = 0x00;
+        wide_t borrow    = 0x00;
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            const wide_t p   = qhat * v[i] + mul_carry;
+            mul_carry        = p >> nbits;
+            const wide_t sub = static_cast<wide_t>(static_cast<wide_t>(u[i + j]) - static_cast<T>(p) - borrow);
+            u[i + j]         = static_cast<T>(sub);
+            borrow           = (sub >> nbits) != 0x00 ? 1 : 0;
+        }
+
+        const wide_t sub = static_cast<wide_t>(static_cast<wide_t>(u[j + n]) - mul_carry - borrow);
+        u[j + n]         = static_cast<T>(sub);
+
+        ////////////////////////////////////////////
+        // 4. q was one too large: add v back
+        if ((sub >> nbits) != 0x00)
+        {
+            --qhat;
+
+            wide_t c = 0x00;
+            for (size_t i = 0; i < n; ++i)
+            {
+                const wide_t tmp = static_cast<wide_t>(u[i + j]) + v[i] + c;
+                u[i + j]         = static_cast<T>(tmp);
+                c                = tmp >> nbits;
+            }
 
-        Cry_multiply(&mul[0] + nbytes, dFirst, dLast, Down);
+            u[j + n] = static_cast<T>(u[j + n] + c);
+        }
 
-        Cry_subtract(rLast, rFirst, rLast, &mul[0], &mul[0] + nbytes);
+        *(div_last - 1 - j) = static_cast<T>(qhat);
+    }
 
-        *(div_last++) = Down;
+    /////////////////////////////////
+    // 5. unnormalize the remainder
+    for (size_t i = 0; i < n; ++i)
+    {
+        const wide_t high = (i + 1 < n) ? u[i + 1] : 0x00;
+        const wide_t w    = (high << nbits) | u[i];
 
-        --shift;
+        *(rem_last - 1 - i) = static_cast<T>(w >> s);
     }
+}
+
+/**
+ * \brief divides two numbers, allocating the Algorithm D workspace
+ */
+template <class T, class Traits = traits<T>>
+void Cry_divide(T* div_last, T* rem_last, const T* first1, const T* last1, const T* first2, const T* last2)
+{
+    Cry_scratch<T> workspace(Cry_divide_workspace_size(last1 - first1, last2 - first2));
 
-    std::copy_backward(rFirst, rLast, rem_last);
+    Cry_divide<T, Traits>(div_last, rem_last, first1, last1, first2, last2, &workspace[0]);
 }
 
 template <class T, class Traits = traits<T>>
@@ -308,9 +1358,9 @@ void Cry_increment(T* first, T* last)
     *(last)    = static_cast<T>(tmp);
     carry      = tmp >> sizeof(carry) * 8;
 
-    for (; (first <= last) && carry;)
+    for (; (first < last) && carry;)
     {
-        tmp     = static_cast<wint_t>(*--last) + static_cast<wint_t>(carry);
+        tmp     = static_cast<wide_t>(*--last) + static_cast<wide_t>(carry);
         *(last) = static_cast<T>(tmp);
         carry   = tmp >> sizeof(carry) * 8;
     }
@@ -332,7 +1382,7 @@ void Cry_decrement(T* first, T* last)
         carry   = 0;
     }
 
-    for (; (first <= last);)
+    for (; (first < last) && carry;)
     {
         if (*--last < carry)
         {
@@ -372,7 +1422,7 @@ void Cry_rotl(T* first, T* last)
 
     for (; first != last; --last)
     {
-        const int z = (*last >> 7) & 0x01;
+        const int z = (*last >> (sizeof(T) * 8 - 1)) & 0x01;
 
         *last <<= 1;
         *last |= static_cast<T>(carry);
@@ -430,13 +1480,41 @@ void Cry_rshift(T* first, T* last)
     }
 }
 
+/**
+ * \brief shifts right by n bits in one pass: whole limbs first, then the remaining sub-limb bits
+ */
 template <class T>
 void Cry_rshift(T* first, T* last, int n)
 {
-    while (n--)
+    if (n <= 0)
+    {
+        return;
+    }
+
+    const size_t nbits = sizeof(T) * 8;
+    const size_t len   = last - first;
+    const size_t words = static_cast<size_t>(n) / nbits;
+    const size_t bits  = static_cast<size_t>(n) % nbits;
+
+    if (words >= len)
     {
-        Cry_rshift(first, last);
+        std::fill(first, last, 0x00);
+        return;
+    }
+
+    for (size_t i = len; i-- > words;)
+    {
+        T x = static_cast<T>(first[i - words] >> bits);
+
+        if (bits != 0 && i > words)
+        {
+            x |= static_cast<T>(first[i - words - 1] << (nbits - bits));
+        }
+
+        first[i] = x;
     }
+
+    std::fill(first, first + words, 0x00);
 }
 
 template <class T>
@@ -456,13 +1534,41 @@ void Cry_lshift(T* first, T* last)
     }
 }
 
+/**
+ * \brief shifts left by n bits in one pass: whole limbs first, then the remaining sub-limb bits
+ */
 template <class T>
 void Cry_lshift(T* first, T* last, int n)
 {
-    while (n--)
+    if (n <= 0)
+    {
+        return;
+    }
+
+    const size_t nbits = sizeof(T) * 8;
+    const size_t len   = last - first;
+    const size_t words = static_cast<size_t>(n) / nbits;
+    const size_t bits  = static_cast<size_t>(n) % nbits;
+
+    if (words >= len)
+    {
+        std::fill(first, last, 0x00);
+        return;
+    }
+
+    for (size_t i = 0; i + words < len; ++i)
     {
-        Cry_lshift(first, last);
+        T x = static_cast<T>(first[i + words] << bits);
+
+        if (bits != 0 && i + words + 1 < len)
+        {
+            x |= static_cast<T>(first[i + words + 1] >> (nbits - bits));
+        }
+
+        first[i] = x;
     }
+
+    std::fill(last - words, last, 0x00);
 }
 
 template <class T>
@@ -0,0 +1,341 @@
+#ifndef CRY_SMALL_VECTOR_HPP
+#define CRY_SMALL_VECTOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+
+namespace cry
+{
+    /**
+     * \brief contiguous sequence that keeps up to N values inline and only allocates for larger sizes
+     * \tparam T trivially copyable value type (limbs)
+     * \tparam N inline capacity
+     */
+    template <class T, size_t N>
+    class small_vector
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "small_vector holds trivially copyable values only");
+        static_assert(N > 0, "small_vector needs a non-zero inline capacity");
+
+      public:
+        using value_type             = T;
+        using size_type              = size_t;
+        using reference              = T&;
+        using const_reference        = const T&;
+        using iterator               = T*;
+        using const_iterator         = const T*;
+        using reverse_iterator       = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        small_vector() noexcept : m_Data(m_Inline), m_Size(0), m_Capacity(N)
+        {
+        }
+
+        explicit small_vector(size_t n, const T& value = T()) : small_vector()
+        {
+            resize(n, value);
+        }
+
+        template <class InputIterator, class = typename std::iterator_traits<InputIterator>::iterator_category>
+        small_vector(InputIterator first, InputIterator last) : small_vector()
+        {
+            assign(first, last);
+        }
+
+        small_vector(std::initializer_list<T> il) : small_vector(il.begin(), il.end())
+        {
+        }
+
+        small_vector(const small_vector& other) : small_vector()
+        {
+            assign(other.begin(), other.end());
+        }
+
+        small_vector(small_vector&& other) noexcept : small_vector()
+        {
+            *this = std::move(other);
+        }
+
+        ~small_vector()
+        {
+            release();
+        }
+
+        small_vector& operator=(const small_vector& other)
+        {
+            if (this != &other)
+            {
+                assign(other.begin(), other.end());
+            }
+
+            return *this;
+        }
+
+        small_vector& operator=(small_vector&& other) noexcept
+        {
+            if (this == &other)
+            {
+                return *this;
+            }
+
+            if (other.is_inline())
+            {
+                // our capacity is at least N, no allocation needed
+                std::copy(other.begin(), other.end(), m_Data);
+                m_Size = other.m_Size;
+            }
+            else
+            {
+                release();
+
+                m_Data     = other.m_Data;
+                m_Size     = other.m_Size;
+                m_Capacity = other.m_Capacity;
+
+                other.m_Data     = other.m_Inline;
+                other.m_Capacity = N;
+            }
+
+            other.m_Size = 0;
+
+            return *this;
+        }
+
+        template <class InputIterator>
+        void assign(InputIterator first, InputIterator last)
+        {
+            const size_t n = static_cast<size_t>(std::distance(first, last));
+
+            m_Size = 0;
+            reserve(n);
+
+            std::copy(first, last, m_Data);
+            m_Size = n;
+        }
+
+        void reserve(size_t n)
+        {
+            if (n <= m_Capacity)
+            {
+                return;
+            }
+
+            const size_t capacity = std::max(n, 2 * m_Capacity);
+
+            T* data = new T[capacity];
+            std::copy(begin(), end(), data);
+
+            const size_t size = m_Size;
+
+            release();
+
+            m_Data     = data;
+            m_Size     = size;
+            m_Capacity = capacity;
+        }
+
+        void resize(size_t n, const T& value = T())
+        {
+            reserve(n);
+
+            if (n > m_Size)
+            {
+                std::fill(m_Data + m_Size, m_Data + n, value);
+            }
+
+            m_Size = n;
+        }
+
+        iterator insert(const_iterator pos, size_t count, const T& value)
+        {
+            const size_t offset = pos - begin();
+
+            reserve(m_Size + count);
+
+            std::copy_backward(begin() + offset, end(), end() + count);
+            std::fill(begin() + offset, begin() + offset + count, value);
+            m_Size += count;
+
+            return begin() + offset;
+        }
+
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            const size_t offset = first - begin();
+            const size_t count  = last - first;
+
+            std::copy(begin() + offset + count, end(), begin() + offset);
+            m_Size -= count;
+
+            return begin() + offset;
+        }
+
+        void push_back(const T& value)
+        {
+            if (m_Size == m_Capacity)
+            {
+                const T copy = value;
+
+                reserve(m_Size + 1);
+                m_Data[m_Size++] = copy;
+                return;
+            }
+
+            m_Data[m_Size++] = value;
+        }
+
+        void swap(small_vector& other) noexcept
+        {
+            if (!is_inline() && !other.is_inline())
+            {
+                std::swap(m_Data, other.m_Data);
+                std::swap(m_Size, other.m_Size);
+                std::swap(m_Capacity, other.m_Capacity);
+                return;
+            }
+
+            small_vector temp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(temp);
+        }
+
+        void clear() noexcept
+        {
+            m_Size = 0;
+        }
+
+        size_t size() const noexcept
+        {
+            return m_Size;
+        }
+
+        bool empty() const noexcept
+        {
+            return m_Size == 0;
+        }
+
+        size_t capacity() const noexcept
+        {
+            return m_Capacity;
+        }
+
+        T* data() noexcept
+        {
+            return m_Data;
+        }
+
+        const T* data() const noexcept
+        {
+            return m_Data;
+        }
+
+        T& operator[](size_t i) noexcept
+        {
+            return m_Data[i];
+        }
+
+        const T& operator[](size_t i) const noexcept
+        {
+            return m_Data[i];
+        }
+
+        T& front() noexcept
+        {
+            return m_Data[0];
+        }
+
+        const T& front() const noexcept
+        {
+            return m_Data[0];
+        }
+
+        T& back() noexcept
+        {
+            return m_Data[m_Size - 1];
+        }
+
+        const T& back() const noexcept
+        {
+            return m_Data[m_Size - 1];
+        }
+
+        iterator begin() noexcept
+        {
+            return m_Data;
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return m_Data;
+        }
+
+        iterator end() noexcept
+        {
+            return m_Data + m_Size;
+        }
+
+        const_iterator end() const noexcept
+        {
+            return m_Data + m_Size;
+        }
+
+        reverse_iterator rbegin() noexcept
+        {
+            return reverse_iterator(end());
+        }
+
+        const_reverse_iterator rbegin() const noexcept
+        {
+            return const_reverse_iterator(end());
+        }
+
+        reverse_iterator rend() noexcept
+        {
+            return reverse_iterator(begin());
+        }
+
+        const_reverse_iterator rend() const noexcept
+        {
+            return const_reverse_iterator(begin());
+        }
+
+        friend bool operator==(const small_vector& lhs, const small_vector& rhs) noexcept
+        {
+            return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+        }
+
+        friend bool operator!=(const small_vector& lhs, const small_vector& rhs) noexcept
+        {
+            return !(lhs == rhs);
+        }
+
+      private:
+        bool is_inline() const noexcept
+        {
+            return m_Data == m_Inline;
+        }
+
+        void release() noexcept
+        {
+            if (!is_inline())
+            {
+                delete[] m_Data;
+            }
+
+            m_Data     = m_Inline;
+            m_Capacity = N;
+            m_Size     = 0;
+        }
+
+      private:
+        T* m_Data;
+        size_t m_Size;
+        size_t m_Capacity;
+        T m_Inline[N];
+    };
+}
+
+#endif
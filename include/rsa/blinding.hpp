@@ -0,0 +1,201 @@
+#ifndef RSA_BLINDING_HPP
+#define RSA_BLINDING_HPP
+
+#include "algorithm.hpp"
+#include "basic_integer.hpp"
+#include "utility/os2ip.hpp"
+#include "utility/worker_pool.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace cry
+{
+    namespace rsa
+    {
+        /**
+         * \brief blinding pairs (r^e, r^(-1)) mod n for the private-key operation
+         *
+         * The pair in use is squared after every operation, (r^e)^2 = (r^2)^e, so the next operation
+         * gets a new blinding factor for two modular squarings. After refresh operations it is replaced
+         * by a pair built from a fresh random r; the worker pool keeps up to reserve of those ready.
+         * Pairs are kept in the Montgomery domain, so blinding and unblinding are one multiplication each.
+         * \tparam Integer integer type
+         */
+        template <class Integer>
+        class blinding
+        {
+          public:
+            blinding(const Integer& n, const Integer& e, size_t refresh, size_t reserve)
+            {
+                if (e < 1)
+                {
+                    throw std::logic_error("blinding needs the public exponent");
+                }
+
+                m_State = std::make_shared<state_type>(n, e, refresh, reserve);
+            }
+
+            /**
+             * \brief calculates unblind(operation(blind(c))), c * r^e is passed to the operation
+             */
+            template <class Operation>
+            Integer apply(const Integer& c, Operation operation) const
+            {
+                const pair_type pair = take(m_State);
+
+                const montgomery_context<Integer>& ctx = m_State->ctx;
+
+                // x * (y * R) * R^(-1) = x * y mod n
+                const Integer blinded = ctx.multiply(c, pair.A);
+
+                return ctx.multiply(operation(blinded), pair.Ai);
+            }
+
+          private:
+            struct pair_type
+            {
+                Integer A;  // r^e * R mod n
+                Integer Ai; // r^(-1) * R mod n
+            };
+
+            struct state_type
+            {
+                state_type(const Integer& modulus, const Integer& exponent, size_t refresh_, size_t reserve_)
+                    : n(modulus), e(exponent), ctx(modulus), refresh(std::max<size_t>(refresh_, 1)), reserve(reserve_)
+                {
+                }
+
+                // immutable after construction, used without the lock
+                const Integer n;
+                const Integer e;
+                const montgomery_context<Integer> ctx;
+                const size_t refresh;
+                const size_t reserve;
+
+                std::mutex mutex;
+                pair_type current;
+                size_t uses = 0;
+                bool has_current = false;
+                std::vector<pair_type> fresh;
+                bool refilling = false;
+            };
+
+            static pair_type generate(const state_type& state)
+            {
+                // r is drawn from random_device itself: a seeded generator would leave only as many factors as seeds
+                std::random_device rd;
+
+                std::vector<uint8_t> bytes((bit_length(state.n) + 7) / 8);
+
+                for (;;)
+                {
+                    for (size_t i = 0; i < bytes.size(); i += sizeof(uint32_t))
+                    {
+                        const uint32_t word = static_cast<uint32_t>(rd());
+                        for (size_t j = 0; j != sizeof(uint32_t) && i + j != bytes.size(); ++j)
+                        {
+                            bytes[i + j] = static_cast<uint8_t>(word >> (8 * j));
+                        }
+                    }
+
+                    const Integer r = OS2IP<Integer>()(bytes) % state.n;
+                    if (r < 2)
+                    {
+                        continue;
+                    }
+
+                    Integer ri;
+                    if (!cry::mod_inverse(ri, r, state.n))
+                    {
+                        continue;
+                    }
+
+                    uint32_t word;
+                    const Integer A = to_word(state.e, word) ? state.ctx.pow(r, word) : state.ctx.pow(r, state.e);
+
+                    return pair_type{ state.ctx.to_montgomery(A), state.ctx.to_montgomery(ri) };
+                }
+            }
+
+            static void refill(const std::shared_ptr<state_type>& state)
+            {
+                // called under state->mutex
+                if (state->refilling || state->fresh.size() >= state->reserve)
+                {
+                    return;
+                }
+
+                state->refilling = true;
+
+                std::weak_ptr<state_type> weak = state;
+                worker_pool::shared().submit([weak] {
+                    for (;;)
+                    {
+                        const auto state = weak.lock();
+                        if (!state)
+                        {
+                            return;
+                        }
+
+                        pair_type pair = generate(*state);
+
+                        std::lock_guard<std::mutex> lock(state->mutex);
+                        state->fresh.push_back(std::move(pair));
+
+                        if (state->fresh.size() >= state->reserve)
+                        {
+                            state->refilling = false;
+                            return;
+                        }
+                    }
+                });
+            }
+
+            static pair_type take(const std::shared_ptr<state_type>& state)
+            {
+                std::unique_lock<std::mutex> lock(state->mutex);
+
+                if (!state->has_current || state->uses >= state->refresh)
+                {
+                    if (state->fresh.empty())
+                    {
+                        // nothing ready: build one here, without blocking the other callers
+                        lock.unlock();
+                        pair_type pair = generate(*state);
+                        lock.lock();
+
+                        state->fresh.push_back(std::move(pair));
+                    }
+
+                    state->current = std::move(state->fresh.back());
+                    state->fresh.pop_back();
+                    state->uses        = 0;
+                    state->has_current = true;
+
+                    refill(state);
+                }
+
+                pair_type pair = state->current;
+
+                ///////////////////////////////////////////////////////////////////
+                // (r^e)^2 and (r^(-1))^2: the next caller never reuses this factor
+                state->current.A  = state->ctx.square(state->current.A);
+                state->current.Ai = state->ctx.square(state->current.Ai);
+                ++state->uses;
+
+                return pair;
+            }
+
+          private:
+            std::shared_ptr<state_type> m_State;
+        };
+    } // namespace rsa
+} // namespace cry
+
+#endif // RSA_BLINDING_HPP
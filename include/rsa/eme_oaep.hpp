@@ -1,11 +1,17 @@
 #ifndef EME_OAEP_HPP
 #define EME_OAEP_HPP
 
+#include <algorithm>
+#include <functional>
 #include <iterator>
+#include <random>
+#include <stdexcept>
+#include <vector>
 
 #include <rsa/mgf.hpp>
 
 #include "digest/sha1.hpp"
+#include "status.hpp"
 
 namespace cry
 {
@@ -19,175 +25,237 @@ namespace cry
             using hash_type = Digest;
 
           public:
+            /**
+             * \brief octets of workspace the pointer overload of try_decode needs for a k octet EM
+             */
+            static constexpr size_t workspace_size(size_t k) noexcept
+            {
+                return k + hLen;
+            }
+
             template <class InputIterator, class OutputIterator>
             static OutputIterator encode(InputIterator first, InputIterator last, OutputIterator result, size_t k, const std::vector<uint8_t>& seedVal = std::vector<uint8_t>(), const std::vector<uint8_t>& L = std::vector<uint8_t>())
             {
-                auto mLen = std::distance(first, last);
-
-                ////////////////////////////////////////////////////////////////
-                // If mLen > k * 2hLen * 2, output "message too long" and stop.
-                if (mLen > k - 2 * hLen - 2)
+                if (!seedVal.empty() && seedVal.size() != hLen)
                 {
-                    throw std::runtime_error("message too long");
+                    throw std::runtime_error("seed length mismatch");
                 }
 
-                ///////////////////////////////////////////////////////////
-                // a. Let lHash = Hash (L), an octet string of length hLen
-                std::vector<uint8_t> lHash;
-                lHash.reserve(hLen);
-
-                Digest()(L.begin(), L.end(), std::back_inserter(lHash));
-
-                ///////////////////////////////////////////////////////////////////////////////
-                // b. Generate an octet string PS consisting of k  mLen  2hLen  2 zero octets.
-                // The length of PS may be zero.
-                const size_t psLen = k - mLen - 2 * hLen - 2;
-                auto PS            = std::vector<uint8_t>(psLen);
-
-                /////////////////////////////////////////////////////////////////////////////
-                // c. Concatenate lHash, PS, a single octet with hexadecimal value 0x01, and
-                // the message M to form a data block DB of length k  hLen  1 octets as
-                // DB = lHash || PS || 0x01 || M .
-                const auto dbLen = k - hLen - 1;
-                auto DB          = std::vector<uint8_t>(dbLen);
-                auto it          = DB.begin();
+                const std::vector<uint8_t> M(first, last);
 
-                it = std::copy(lHash.begin(), lHash.end(), it);
+                std::vector<uint8_t> EM(k);
+                throw_on_error(try_encode(M.data(), M.size(), EM.data(), k, seedVal.empty() ? nullptr : seedVal.data(), L.data(), L.size()));
 
-                it = std::copy(PS.begin(), PS.end(), it);
+                result = std::copy(EM.begin(), EM.end(), result);
 
-                *it++ = 0x01;
+                return result;
+            }
 
-                it = std::copy(first, last, it);
+            /**
+             * \brief encodes M = [m, m + mLen) into the k octets of em without throwing or allocating
+             * \param seed hLen octets, nullptr - a random seed
+             * \param L label of lLen octets
+             * \return status::message_too_long if mLen > k - 2hLen - 2
+             */
+            static status try_encode(const uint8_t* m, size_t mLen, uint8_t* em, size_t k, const uint8_t* seed, const uint8_t* L, size_t lLen) noexcept
+            {
+                ////////////////////////////////////////////////////////////////
+                // If mLen > k - 2hLen - 2, output "message too long" and stop.
+                if (k < 2 * hLen + 2 || mLen > k - 2 * hLen - 2)
+                {
+                    return status::message_too_long;
+                }
 
-                /////////////////////////////////////////////////////////
-                // d. Generate a random octet string seed of length hLen.
-                auto seed = seedVal;
-                if (seed.empty())
+                try
                 {
-                    seed.resize(hLen);
+                    const size_t dbLen = k - hLen - 1;
+                    uint8_t* maskedSeed = em + 1;
+                    uint8_t* maskedDB   = em + 1 + hLen;
+
+                    ///////////////////////////////////////////////////////////
+                    // a. Let lHash = Hash (L), an octet string of length hLen
+                    Digest()(L, L + lLen, maskedDB);
+
+                    /////////////////////////////////////////////////////////////////////////////
+                    // b. Generate an octet string PS consisting of k - mLen - 2hLen - 2 zero octets.
+                    //
+                    // c. Concatenate lHash, PS, a single octet with hexadecimal value 0x01, and
+                    // the message M to form a data block DB of length k - hLen - 1 octets as
+                    // DB = lHash || PS || 0x01 || M, built in place behind maskedSeed.
+                    const size_t psLen = k - mLen - 2 * hLen - 2;
+
+                    std::fill_n(maskedDB + hLen, psLen, 0x00);
+                    maskedDB[hLen + psLen] = 0x01;
+                    std::copy(m, m + mLen, maskedDB + hLen + psLen + 1);
+
+                    /////////////////////////////////////////////////////////
+                    // d. Generate a random octet string seed of length hLen.
+                    if (seed != nullptr)
+                    {
+                        std::copy(seed, seed + hLen, maskedSeed);
+                    }
+                    else
+                    {
+                        std::random_device rd;
+                        std::mt19937 gen(rd());
+                        std::uniform_int_distribution<> uid(1, 255);
 
-                    std::random_device rd;
-                    std::mt19937 gen(rd());
-                    std::uniform_int_distribution<> uid(1, 255);
+                        std::generate(maskedSeed, maskedSeed + hLen, [&uid, &gen]() { return uid(gen); });
+                    }
 
-                    std::generate(std::begin(seed), std::end(seed), [&uid, &gen]() { return uid(gen); });
-                }
+                    MGFType mgf;
 
-                ////////////////////////////////////////////
-                // e. Let dbMask = MGF (seed, k  hLen  1)
-                auto dbMask = std::vector<uint8_t>(dbLen);
+                    ////////////////////////////////////////////
+                    // e. Let dbMask = MGF (seed, k - hLen - 1)
+                    //
+                    // f. Let maskedDB = DB \xor dbMask.
+                    mgf.mask(maskedSeed, maskedSeed + hLen, maskedDB, dbLen);
 
-                MGFType mgf;
-                mgf(seed.begin(), seed.end(), dbMask.begin(), dbLen);
+                    /////////////////////////////////////////
+                    // g. Let seedMask = MGF(maskedDB, hLen).
+                    //
+                    // h. Let maskedSeed = seed \xor seedMask.
+                    mgf.mask(maskedDB, maskedDB + dbLen, maskedSeed, hLen);
 
-                /////////////////////////////////////
-                // f. Let maskedDB = DB \xor dbMask.
-                std::vector<uint8_t> maskedDB(dbLen);
-                std::transform(DB.begin(), DB.end(), dbMask.begin(), maskedDB.begin(), std::bit_xor<>());
+                    /////////////////////////////////////////////////////////////////////////////
+                    // i. EM = 0x00 || maskedSeed || maskedDB.
+                    em[0] = 0x00;
 
-                /////////////////////////////////////////
-                // g. Let seedMask = MGF(maskedDB, hLen).
-                std::vector<uint8_t> seedMask(hLen);
-                mgf(maskedDB.begin(), maskedDB.end(), seedMask.begin(), hLen);
+                    return status::ok;
+                }
+                catch (...)
+                {
+                    return status::internal_error;
+                }
+            }
 
-                //////////////////////////////////////////
-                // h. Let maskedSeed = seed \xor seedMask.
-                std::vector<uint8_t> maskedSeed(hLen);
-                std::transform(seed.begin(), seed.end(), seedMask.begin(), maskedSeed.begin(), std::bit_xor<>());
+            template <class InputIterator, class OutputIterator>
+            static OutputIterator decode(InputIterator first, InputIterator last, OutputIterator result, size_t k, const std::vector<uint8_t>& L = std::vector<uint8_t>())
+            {
+                // EM may come without its leading 0x00 octet Y
+                const size_t sz = std::distance(first, last);
+                if (sz > k)
+                {
+                    throw std::runtime_error("decryption error");
+                }
 
-                /////////////////////////////////////////////////////////////////////////////
-                // i. Concatenate a single octet with hexadecimal value 0x00, maskedSeed, and
-                // maskedDB to form an encoded message EM of length k octets as
-                // EM = 0x00 || maskedSeed || maskedDB.
+                // EM, M and the workspace in one allocation
+                std::vector<uint8_t> buffer(2 * k + workspace_size(k));
+                uint8_t* EM = buffer.data();
+                uint8_t* M  = EM + k;
 
-                *result++ = 0x00;
+                std::copy(first, last, EM + (k - sz));
 
-                result = std::copy(maskedSeed.begin(), maskedSeed.end(), result);
+                size_t mLen = 0;
+                throw_on_error(try_decode(EM, k, M, k, mLen, L.data(), L.size(), M + k));
 
-                result = std::copy(maskedDB.begin(), maskedDB.end(), result);
+                result = std::copy(M, M + mLen, result);
 
                 return result;
             }
 
-            template <class InputIterator, class OutputIterator>
-            static OutputIterator decode(InputIterator first, InputIterator last, OutputIterator result, size_t k, const std::vector<uint8_t>& L = std::vector<uint8_t>())
+            /**
+             * \brief decodes EM = Y || maskedSeed || maskedDB of k octets without throwing
+             * \param out receives M, capacity octets available
+             * \param mLen length of M, set on status::ok
+             * \return status::decryption_error for every malformed EM alike
+             */
+            static status try_decode(const uint8_t* em, size_t k, uint8_t* out, size_t capacity, size_t& mLen, const std::vector<uint8_t>& L = std::vector<uint8_t>()) noexcept
             {
+                try
+                {
+                    std::vector<uint8_t> workspace(workspace_size(k));
 
-                // a.
-                auto lHash = std::vector<uint8_t>(hLen);
-
-                Digest hash;
-                hash(L.begin(), L.end(), lHash.begin());
+                    return try_decode(em, k, out, capacity, mLen, L.data(), L.size(), workspace.data());
+                }
+                catch (...)
+                {
+                    mLen = 0;
+                    return status::internal_error;
+                }
+            }
 
-                // b. Separate the encoded message EM into a single octet Y, an octet
-                // string maskedSeed of length hLen, and an octet string maskedDB of
-                // length k - hLen - 1 as EM = Y || maskedSeed || maskedDB.
-                const size_t sz = std::distance(first, last);
+            /**
+             * \brief try_decode without allocating, the label is [L, L + lLen)
+             * \param workspace workspace_size(k) octets, contents on return are unspecified
+             */
+            static status try_decode(const uint8_t* em, size_t k, uint8_t* out, size_t capacity, size_t& mLen, const uint8_t* L, size_t lLen, uint8_t* workspace) noexcept
+            {
+                mLen = 0;
 
-                if (sz > k)
+                if (k < 2 * hLen + 2)
                 {
-                    throw std::runtime_error("decryption error");
+                    return status::decryption_error;
                 }
 
-                if (sz == k)
+                try
                 {
-                    if (*first++ != 0x00)
+                    // b. Separate the encoded message EM into a single octet Y, an octet
+                    // string maskedSeed of length hLen, and an octet string maskedDB of
+                    // length k - hLen - 1 as EM = Y || maskedSeed || maskedDB.
+                    const uint8_t* maskedSeed = em + 1;
+                    const uint8_t* maskedDB   = em + 1 + hLen;
+                    const size_t dbLen        = k - hLen - 1;
+
+                    // workspace = seed || DB || lHash
+                    uint8_t* seed  = workspace;
+                    uint8_t* DB    = seed + hLen;
+                    uint8_t* lHash = DB + dbLen;
+
+                    // a.
+                    Digest()(L, L + lLen, lHash);
+
+                    // c. Let seedMask = MGF(maskedDB, hLen).
+                    //
+                    // d. Let seed = maskedSeed \xor seedMask.
+                    MGFType mgf;
+
+                    std::copy(maskedSeed, maskedSeed + hLen, seed);
+                    mgf.mask(maskedDB, maskedDB + dbLen, seed, hLen);
+
+                    // e. Let dbMask = MGF(seed, k - hLen - 1).
+                    //
+                    // f. Let DB = maskedDB \xor dbMask.
+                    std::copy(maskedDB, maskedDB + dbLen, DB);
+                    mgf.mask(seed, seed + hLen, DB, dbLen);
+
+                    // g. Separate DB into an octet string lHash' of length hLen, a
+                    // (possibly empty) padding string PS consisting of octets with
+                    // hexadecimal value 0x00, and a message M as DB = lHash' || PS ||
+                    // 0x01 || M. If there is no octet with hexadecimal value 0x01 to
+                    // separate PS from M, if lHash does not equal lHash', or if Y is
+                    // nonzero, output "decryption error" and stop.
+                    uint8_t bad = em[0];
+                    for (size_t i = 0; i != hLen; ++i)
                     {
-                        throw std::runtime_error("decryption error");
+                        bad |= DB[i] ^ lHash[i];
                     }
-                }
-
-                std::vector<uint8_t> maskedSeed(first, first + hLen);
-                first += hLen;
-
-                const size_t dbLen = k - hLen - 1;
-                std::vector<uint8_t> maskedDB(first, first + dbLen);
-
-                // c. Let seedMask = MGF(maskedDB, hLen).
-                std::vector<uint8_t> seedMask(hLen);
 
-                MGFType mgf;
-                mgf(maskedDB.begin(), maskedDB.end(), seedMask.begin(), hLen);
+                    size_t i = hLen;
+                    for (; i != dbLen && DB[i] == 0x00; ++i)
+                        ;
 
-                // d. Let seed = maskedSeed \xor seedMask.
-                std::vector<uint8_t> seed(hLen);
-                std::transform(maskedSeed.begin(), maskedSeed.end(), seedMask.begin(), seed.begin(), std::bit_xor<>());
+                    if (bad != 0x00 || i == dbLen || DB[i] != 0x01)
+                    {
+                        return status::decryption_error;
+                    }
 
-                // e. Let dbMask = MGF(seed, k - hLen - 1).
-                std::vector<uint8_t> dbMask(dbLen);
-                mgf(seed.begin(), seed.end(), dbMask.begin(), dbLen);
+                    ++i;
 
-                // f. Let DB = maskedDB \xor dbMask.
-                std::vector<uint8_t> DB(dbLen);
-                std::transform(maskedDB.begin(), maskedDB.end(), dbMask.begin(), DB.begin(), std::bit_xor<>());
+                    if (dbLen - i > capacity)
+                    {
+                        return status::buffer_too_small;
+                    }
 
-                // g. Separate DB into an octet string lHash' of length hLen, a
-                // (possibly empty) padding string PS consisting of octets with
-                // hexadecimal value 0x00, and a message M as DB = lHash' || PS ||
-                // 0x01 || M. If there is no octet with hexadecimal value 0x01 to
-                // separate PS from M, if lHash does not equal lHash', or if Y is
-                // nonzero, output "decryption error" and stop.
+                    std::copy(DB + i, DB + dbLen, out);
+                    mLen = dbLen - i;
 
-                auto it = DB.begin();
-                const std::vector<uint8_t> lHash_(DB.begin(), it + hLen);
-                it += hLen;
-                if (lHash != lHash_)
-                {
-                    throw std::runtime_error("decryption_error");
+                    return status::ok;
                 }
-
-                for (; it != DB.end() && *it == 0x00; ++it)
-                    ;
-
-                if (*it++ != 0x01)
+                catch (...)
                 {
-                    throw std::runtime_error("decryption_error");
+                    return status::internal_error;
                 }
-
-                result = std::copy(it, DB.end(), result);
-
-                return result;
             }
         };
     } // namespace rsa
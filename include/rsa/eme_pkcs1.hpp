@@ -3,6 +3,9 @@
 
 #include <algorithm>
 #include <random>
+#include <vector>
+
+#include "status.hpp"
 
 namespace cry
 {
@@ -15,54 +18,115 @@ namespace cry
             template <class InputIterator, class OutputIterator>
             static OutputIterator encode(InputIterator first, InputIterator last, OutputIterator result, size_t k, const std::vector<uint8_t>& randVal = std::vector<uint8_t>())
             {
-                const size_t mLen = std::distance(first, last);
-                if (mLen > k - 11)
+                const std::vector<uint8_t> M(first, last);
+                if (!randVal.empty() && randVal.size() + M.size() + 3 != k)
                 {
-                    throw std::runtime_error("message too long");
+                    throw std::runtime_error("encoding error");
                 }
 
-                size_t psLen = k - mLen - 3;
+                std::vector<uint8_t> EM(k);
+                throw_on_error(try_encode(M.data(), M.size(), EM.data(), k, randVal.empty() ? nullptr : randVal.data()));
 
-                *result++ = 0x00;
-                *result++ = 0x02;
+                result = std::copy(EM.begin(), EM.end(), result);
 
-                auto rand = randVal;
-                if (rand.empty())
-                {
-                    std::random_device rd;
-                    std::mt19937 gen(rd());
-                    std::uniform_int_distribution<> uid(1, 255);
+                return result;
+            }
 
-                    result = std::generate_n(result, psLen, [&uid, &gen]() { return uid(gen); });
+            /**
+             * \brief encodes EM = 0x00 || 0x02 || PS || 0x00 || M straight into the k octets at em, without throwing
+             * \param ps k - mLen - 3 nonzero octets, nullptr - random ones
+             */
+            static status try_encode(const uint8_t* m, size_t mLen, uint8_t* em, size_t k, const uint8_t* ps = nullptr) noexcept
+            {
+                if (k < 11 || mLen > k - 11)
+                {
+                    return status::message_too_long;
                 }
 
-                // result += psLen;
+                const size_t psLen = k - mLen - 3;
 
-                *result++ = 0x00;
+                em[0] = 0x00;
+                em[1] = 0x02;
 
-                result = std::copy(first, last, result);
+                if (ps)
+                {
+                    if (std::find(ps, ps + psLen, 0x00) != ps + psLen)
+                    {
+                        return status::encoding_error;
+                    }
 
-                return result;
+                    std::copy(ps, ps + psLen, em + 2);
+                }
+                else
+                {
+                    try
+                    {
+                        std::random_device rd;
+                        std::mt19937 gen(rd());
+                        std::uniform_int_distribution<> uid(1, 255);
+
+                        std::generate_n(em + 2, psLen, [&uid, &gen]() { return static_cast<uint8_t>(uid(gen)); });
+                    }
+                    catch (...)
+                    {
+                        return status::internal_error;
+                    }
+                }
+
+                em[2 + psLen] = 0x00;
+                std::copy(m, m + mLen, em + 3 + psLen);
+
+                return status::ok;
             }
 
             template <class InputIterator, class OutputIterator>
             static OutputIterator decode(InputIterator first, InputIterator last, OutputIterator result)
             {
-                if (first != last && *first++ != 0x00)
-                    throw std::runtime_error("decryption error");
+                const std::vector<uint8_t> EM(first, last);
+                std::vector<uint8_t> M(EM.size());
+
+                size_t mLen = 0;
+                throw_on_error(try_decode(EM.data(), EM.size(), M.data(), M.size(), mLen));
 
-                if (first != last && *first++ != 0x02)
-                    throw std::runtime_error("decryption error");
+                result = std::copy(M.begin(), M.begin() + mLen, result);
 
-                for (; first != last && *first != 0x00; ++first)
+                return result;
+            }
+
+            /**
+             * \brief decodes EM = 0x00 || 0x02 || PS || 0x00 || M of k octets, PS at least 8 octets, without throwing
+             * \param out receives M, capacity octets available
+             * \param mLen length of M, set on status::ok
+             */
+            static status try_decode(const uint8_t* em, size_t k, uint8_t* out, size_t capacity, size_t& mLen) noexcept
+            {
+                mLen = 0;
+
+                if (k < 11 || em[0] != 0x00 || em[1] != 0x02)
+                {
+                    return status::decryption_error;
+                }
+
+                size_t i = 2;
+                for (; i != k && em[i] != 0x00; ++i)
                     ;
 
-                if (*first != 0x00)
-                    throw std::runtime_error("decryption error");
+                if (i == k || i < 10)
+                {
+                    return status::decryption_error;
+                }
 
-                result = std::copy(first, last, result);
+                ++i;
 
-                return result;
+                if (k - i > capacity)
+                {
+                    return status::buffer_too_small;
+                }
+
+                std::copy(em + i, em + k, out);
+                mLen = k - i;
+
+                return status::ok;
             }
         };
     } // namespace rsa
@@ -2,6 +2,11 @@
 #define EMSA_PKCS1_HPP
 
 #include "oid.hpp"
+#include "status.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
 
 namespace cry
 {
@@ -15,33 +20,90 @@ namespace cry
             template <class InputIterator, class OutputIterator>
             static OutputIterator encode(InputIterator first, InputIterator last, OutputIterator result, size_t emLen)
             {
+                uint8_t hash[Digest::size];
+                Digest()(first, last, hash);
 
-                std::vector<uint8_t> hash;
-                hash.reserve(Digest::size);
+                const std::vector<uint8_t>& EM = prefix(emLen);
 
-                Digest()(first, last, std::back_inserter(hash));
+                result = std::copy(EM.begin(), EM.end(), result);
 
-                auto oid            = OID<Digest>::value();
-                const size_t oidLen = oid.size();
-                const size_t hLen   = hash.size();
-                const size_t tLen   = hLen + oidLen;
+                result = std::copy(hash, hash + Digest::size, result);
 
-                const size_t psLen = emLen - tLen - 3;
+                return result;
+            }
+
+            /**
+             * \brief encodes the message [m, m + mLen) straight into the emLen octets at em, without throwing
+             */
+            static status try_encode(const uint8_t* m, size_t mLen, uint8_t* em, size_t emLen) noexcept
+            {
+                uint8_t hash[Digest::size];
+                Digest()(m, m + mLen, hash);
+
+                return try_encode_hash(hash, em, emLen);
+            }
+
+            /**
+             * \brief encodes a precomputed hash of Digest::size octets, see try_encode
+             */
+            static status try_encode_hash(const uint8_t* hash, uint8_t* em, size_t emLen) noexcept
+            {
+                try
+                {
+                    const std::vector<uint8_t>& EM = prefix(emLen);
+
+                    std::copy(hash, hash + Digest::size, std::copy(EM.begin(), EM.end(), em));
+
+                    return status::ok;
+                }
+                catch (const std::runtime_error&)
+                {
+                    return status::encoding_error;
+                }
+                catch (...)
+                {
+                    return status::internal_error;
+                }
+            }
+
+            /**
+             * \brief 00 || 01 || PS || 00 || DigestInfo header, everything of EM but the hash
+             *
+             * Depends on the digest and emLen only, so it is built once per thread for the last length used.
+             */
+            static const std::vector<uint8_t>& prefix(size_t emLen)
+            {
+                thread_local std::vector<uint8_t> EM;
+                thread_local size_t cachedLen = 0;
+
+                if (cachedLen == emLen)
+                {
+                    return EM;
+                }
 
-                std::vector<uint8_t> PS(psLen, 0xFF);
+                auto oid            = OID<Digest>::value();
+                const size_t oidLen = oid.size();
+                const size_t tLen   = Digest::size + oidLen;
 
-                *result++ = 0x00;
-                *result++ = 0x01;
+                if (emLen < tLen + 11)
+                {
+                    throw std::runtime_error("intended encoded message length too short");
+                }
 
-                result = std::copy(PS.begin(), PS.end(), result);
+                const size_t psLen = emLen - tLen - 3;
 
-                *result++ = 0x00;
+                EM.clear();
+                EM.reserve(emLen - Digest::size);
 
-                result = std::copy(oid.begin(), oid.end(), result);
+                EM.push_back(0x00);
+                EM.push_back(0x01);
+                EM.insert(EM.end(), psLen, 0xFF);
+                EM.push_back(0x00);
+                EM.insert(EM.end(), oid.begin(), oid.end());
 
-                result = std::copy(hash.begin(), hash.end(), result);
+                cachedLen = emLen;
 
-                return result;
+                return EM;
             }
 
             template <class InputIterator, class OutputIterator>
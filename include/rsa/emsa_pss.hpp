@@ -1,9 +1,14 @@
 #ifndef EMSA_PSS_H
 #define EMSA_PSS_H
 
+#include <algorithm>
 #include <functional>
+#include <random>
 #include <rsa/mgf.hpp>
 #include <digest/sha1.hpp>
+#include <vector>
+
+#include "status.hpp"
 
 namespace cry
 {
@@ -17,213 +22,340 @@ namespace cry
             template <class InputIterator, class OutputIterator>
             static OutputIterator encode(InputIterator first, InputIterator last, OutputIterator result, size_t emBits, const std::vector<uint8_t>& saltVal = std::vector<uint8_t>())
             {
-                const size_t k     = emBits / 8;
-                const size_t emLen = (emBits % 8) == 0 ? k : k + 1;
-                const size_t hLen  = Digest::size;
-                const size_t zBits = (emBits - 1) & 0x7; // 8 * emLen - emBits;
-
                 ///////////////////////////////////////////////////////////
                 // 2. Let mHash = Hash(M), an octet string of length hLen.
-                std::vector<uint8_t> mHash(first, last);
-                //mHash.reserve(hLen);
-                //Digest()(first, last, std::back_inserter(mHash));
+                std::vector<uint8_t> mHash(Digest::size);
+                Digest()(first, last, mHash.begin());
 
-                ////////////////////////////////////////////////////////////////////
-                // 3.  If emLen < hLen + sLen + 2, output "encoding error" and stop.
-                if (emLen < hLen + sLen + 2)
+                return encode_hash(mHash.begin(), mHash.end(), result, emBits, saltVal);
+            }
+
+            /**
+             * \brief EMSA-PSS encoding from step 3 on, mHash = Hash(M) is computed by the caller
+             */
+            template <class HInputIterator, class OutputIterator>
+            static OutputIterator encode_hash(HInputIterator h_first, HInputIterator h_last, OutputIterator result, size_t emBits, const std::vector<uint8_t>& saltVal = std::vector<uint8_t>())
+            {
+                const std::vector<uint8_t> mHash(h_first, h_last);
+                if (mHash.size() != Digest::size)
                 {
-                    throw std::runtime_error("encoding error");
+                    throw std::runtime_error("digest length mismatch");
                 }
 
-                ///////////////////////////////////////////////////////////
-                // 4.  Generate a random octet string salt of length sLen;
-                // if sLen = 0, then salt is the empty string.
-                std::vector<uint8_t> salt = saltVal;
-                if (salt.empty())
+                if (!saltVal.empty() && saltVal.size() != sLen)
                 {
-
-                    salt.resize(sLen);
-                    std::random_device rd;
-                    std::mt19937 gen(rd());
-                    std::uniform_int_distribution<> uid(1, 255);
-
-                    std::generate(std::begin(salt), std::end(salt), [&uid, &gen]() { return uid(gen); });
+                    throw_on_error(status::encoding_error);
                 }
 
-                //////////////////////////////////////////////////////////////
-                // 5.  Let M' = (0x)00 00 00 00 00 00 00 00 || mHash || salt;
-                // M' is an octet string of length 8 + hLen + sLen with eight initial zero octets.
-                std::vector<uint8_t> M_(8 + hLen + sLen, 0x00);
-                std::vector<uint8_t>::iterator it(M_.begin());
+                // EM || workspace in one allocation
+                const size_t emLen = (emBits + 7) / 8;
 
-                it += 8;
+                std::vector<uint8_t> buffer(emLen + workspace_size(emLen));
+                throw_on_error(try_encode_hash(mHash.data(), buffer.data(), emLen, emBits, saltVal.empty() ? nullptr : saltVal.data(), buffer.data() + emLen));
 
-                it = std::copy(mHash.begin(), mHash.end(), it);
+                result = std::copy(buffer.begin(), buffer.begin() + emLen, result);
 
-                it = std::copy(salt.begin(), salt.end(), it);
+                return result;
+            }
 
-                ///////////////////////////////////////////////////////
-                // 6. Let H = Hash(M'), an octet string of length hLen.
-                std::vector<uint8_t> H;
-                H.reserve(hLen);
-                Digest()(M_.begin(), M_.end(), std::back_inserter(H));
+            /**
+             * \brief octets of workspace the pointer overloads of try_encode, try_encode_hash and try_verify_hash need for an emLen octet EM
+             */
+            static constexpr size_t workspace_size(size_t emLen) noexcept
+            {
+                return emLen + 8 + Digest::size + sLen;
+            }
 
-                //////////////////////////////////////////////////////////////////////////////////////
-                // 7.  Generate an octet string PS consisting of emLen - sLen - hLen - 2 zero octets.
-                // The length of PS may be 0.
-                const size_t psLen = emLen - sLen - hLen - 2;
-                std::vector<uint8_t> PS(psLen);
+            /**
+             * \brief EMSA-PSS encoding of the message [m, m + mLen) without throwing
+             * \param em receives the emLen = ceil(emBits / 8) octets of EM, capacity octets available
+             */
+            static status try_encode(const uint8_t* m, size_t mLen, uint8_t* em, size_t capacity, size_t emBits, const std::vector<uint8_t>& saltVal = std::vector<uint8_t>()) noexcept
+            {
+                uint8_t mHash[Digest::size];
+                Digest()(m, m + mLen, mHash);
 
-                ////////////////////////////////////
-                // 8.  Let DB = PS || 0x01 || salt;
-                // DB is an octet string of length emLen - hLen - 1.
-                const size_t dbLen = emLen - hLen - 1;
-                std::vector<uint8_t> DB(dbLen);
-                std::vector<uint8_t>::iterator itDb(DB.begin());
+                return try_encode_hash(mHash, em, capacity, emBits, saltVal);
+            }
 
-                itDb = std::copy(PS.begin(), PS.end(), itDb);
+            /**
+             * \brief try_encode without allocating
+             * \param salt sLen octets, nullptr - a random salt
+             * \param workspace workspace_size(capacity) octets, contents on return are unspecified
+             */
+            static status try_encode(const uint8_t* m, size_t mLen, uint8_t* em, size_t capacity, size_t emBits, const uint8_t* salt, uint8_t* workspace) noexcept
+            {
+                uint8_t mHash[Digest::size];
+                Digest()(m, m + mLen, mHash);
 
-                *itDb++ = 0x01;
+                return try_encode_hash(mHash, em, capacity, emBits, salt, workspace);
+            }
 
-                itDb = std::copy(salt.begin(), salt.end(), itDb);
+            /**
+             * \brief EMSA-PSS encoding of the Digest::size octets of mHash without throwing, see try_encode
+             * \param saltVal sLen octets, empty - a random salt
+             */
+            static status try_encode_hash(const uint8_t* mHash, uint8_t* em, size_t capacity, size_t emBits, const std::vector<uint8_t>& saltVal = std::vector<uint8_t>()) noexcept
+            {
+                if (!saltVal.empty() && saltVal.size() != sLen)
+                {
+                    return status::encoding_error;
+                }
 
-                //////////////////////////////////////////
-                // 9. Let dbMask = MGF (emLen - hLen - 1)
-                std::vector<uint8_t> dbMask(dbLen);
+                try
+                {
+                    std::vector<uint8_t> workspace(workspace_size((emBits + 7) / 8));
 
-                MGFType mgf;
-                mgf(H.begin(), H.end(), dbMask.begin(), dbLen);
+                    return try_encode_hash(mHash, em, capacity, emBits, saltVal.empty() ? nullptr : saltVal.data(), workspace.data());
+                }
+                catch (...)
+                {
+                    return status::internal_error;
+                }
+            }
 
-                /////////////////////////////////////
-                // 10. Let maskedDB = DB \xor dbMask.
-                std::vector<uint8_t> maskedDB(dbLen);
-                std::transform(DB.begin(), DB.end(), dbMask.begin(), maskedDB.begin(), std::bit_xor<>());
+            /**
+             * \brief try_encode_hash without allocating, DB is built and masked in place in em
+             * \param salt sLen octets, nullptr - a random salt
+             * \param workspace workspace_size(emLen) octets, contents on return are unspecified
+             */
+            static status try_encode_hash(const uint8_t* mHash, uint8_t* em, size_t capacity, size_t emBits, const uint8_t* salt, uint8_t* workspace) noexcept
+            {
+                const size_t k     = emBits / 8;
+                const size_t emLen = (emBits % 8) == 0 ? k : k + 1;
+                const size_t hLen  = Digest::size;
+                const size_t zBits = 8 * emLen - emBits;
 
-                ///////////////////////////////////////////////////////////////////////////////////////
-                // 11. Set the leftmost 8emLen - emBits bits of the leftmost octet in maskedDB to zero.
-                if (zBits > 0)
-                    *maskedDB.begin() &= (0xFF >> (8 - zBits));
+                ////////////////////////////////////////////////////////////////////
+                // 3.  If emLen < hLen + sLen + 2, output "encoding error" and stop.
+                if (emLen < hLen + sLen + 2)
+                {
+                    return status::encoding_error;
+                }
 
-                ///////////////////////////////////////
-                // 12. Let EM = maskedDB || H || 0xbc.
-                result = std::copy(maskedDB.begin(), maskedDB.end(), result);
+                if (capacity < emLen)
+                {
+                    return status::buffer_too_small;
+                }
+
+                try
+                {
+                    uint8_t* M_ = workspace;
 
-                result = std::copy(H.begin(), H.end(), result);
+                    ///////////////////////////////////////////////////////////
+                    // 4.  Generate a random octet string salt of length sLen;
+                    // if sLen = 0, then salt is the empty string.
+                    uint8_t* salt_ = M_ + 8 + hLen;
+                    if (salt != nullptr)
+                    {
+                        std::copy(salt, salt + sLen, salt_);
+                    }
+                    else
+                    {
+                        std::random_device rd;
+                        std::mt19937 gen(rd());
+                        std::uniform_int_distribution<> uid(1, 255);
 
-                *result++ = 0xbc;
+                        std::generate(salt_, salt_ + sLen, [&uid, &gen]() { return uid(gen); });
+                    }
 
-                return result;
+                    //////////////////////////////////////////////////////////////
+                    // 5.  Let M' = (0x)00 00 00 00 00 00 00 00 || mHash || salt;
+                    // M' is an octet string of length 8 + hLen + sLen with eight initial zero octets.
+                    std::fill_n(M_, 8, 0x00);
+                    std::copy(mHash, mHash + hLen, M_ + 8);
+
+                    ///////////////////////////////////////////////////////
+                    // 6. Let H = Hash(M'), an octet string of length hLen.
+                    const size_t dbLen = emLen - hLen - 1;
+                    uint8_t* H         = em + dbLen;
+                    Digest()(M_, M_ + 8 + hLen + sLen, H);
+
+                    //////////////////////////////////////////////////////////////////////////////////////
+                    // 7.  Generate an octet string PS consisting of emLen - sLen - hLen - 2 zero octets.
+                    // The length of PS may be 0.
+                    //
+                    // 8.  Let DB = PS || 0x01 || salt;
+                    // DB is an octet string of length emLen - hLen - 1, built in place in front of H.
+                    const size_t psLen = emLen - sLen - hLen - 2;
+
+                    std::fill_n(em, psLen, 0x00);
+                    em[psLen] = 0x01;
+                    std::copy(salt_, salt_ + sLen, em + psLen + 1);
+
+                    //////////////////////////////////////////
+                    // 9. Let dbMask = MGF (emLen - hLen - 1)
+                    //
+                    // 10. Let maskedDB = DB \xor dbMask.
+                    MGFType mgf;
+                    mgf.mask(H, H + hLen, em, dbLen);
+
+                    ///////////////////////////////////////////////////////////////////////////////////////
+                    // 11. Set the leftmost 8emLen - emBits bits of the leftmost octet in maskedDB to zero.
+                    if (zBits > 0)
+                        em[0] &= (0xFF >> zBits);
+
+                    ///////////////////////////////////////
+                    // 12. Let EM = maskedDB || H || 0xbc.
+                    em[emLen - 1] = 0xbc;
+
+                    return status::ok;
+                }
+                catch (...)
+                {
+                    return status::internal_error;
+                }
             }
 
             template <class InputIterator, class MInputIterator>
             bool static verify(MInputIterator m_first, MInputIterator m_last, InputIterator em_first, InputIterator em_last, size_t emBits)
             {
-                const size_t k     = emBits / 8;
-                const size_t emLen = (emBits % 8) == 0 ? k : k + 1;
-                const size_t hLen  = Digest::size;
-                const size_t zBits = (emBits - 1) & 0x7; //8 * emLen - emBits;
-
                 //////////////////////////////////////////////////////////
                 // 2. Let mHash = Hash(M), an octet string of length hLen.
-                Digest hash;
+                std::vector<uint8_t> mHash(Digest::size);
+                Digest()(m_first, m_last, mHash.begin());
+
+                return verify_hash(mHash.begin(), mHash.end(), em_first, em_last, emBits);
+            }
+
+            /**
+             * \brief EMSA-PSS verification from steps 3 on, mHash = Hash(M) is computed by the caller
+             * \param em_first, em_last EM, leading zero octets beyond emLen are ignored
+             * \return returns "FALSE" if EM is inconsistent
+             */
+            template <class InputIterator, class HInputIterator>
+            bool static verify_hash(HInputIterator h_first, HInputIterator h_last, InputIterator em_first, InputIterator em_last, size_t emBits)
+            {
+                const std::vector<uint8_t> mHash(h_first, h_last);
+                if (mHash.size() != Digest::size)
+                {
+                    throw std::runtime_error("digest length mismatch");
+                }
+
+                const std::vector<uint8_t> EM(em_first, em_last);
+
+                const size_t emLen = (emBits + 7) / 8;
+                if (EM.size() < emLen || std::any_of(EM.begin(), EM.end() - emLen, [](uint8_t x) { return x != 0x00; }))
+                {
+                    return false;
+                }
+
+                const status result = try_verify_hash(mHash.data(), EM.data() + (EM.size() - emLen), emLen, emBits);
+                if (result == status::internal_error)
+                {
+                    throw_on_error(result);
+                }
+
+                return result == status::ok;
+            }
+
+            /**
+             * \brief EMSA-PSS verification of EM of emLen octets against the Digest::size octets of mHash without throwing
+             * \return status::ok or status::inconsistent
+             */
+            static status try_verify_hash(const uint8_t* mHash, const uint8_t* em, size_t emLen, size_t emBits) noexcept
+            {
+                try
+                {
+                    std::vector<uint8_t> workspace(workspace_size(emLen));
+
+                    return try_verify_hash(mHash, em, emLen, emBits, workspace.data());
+                }
+                catch (...)
+                {
+                    return status::internal_error;
+                }
+            }
 
-                std::vector<uint8_t> mHash(hLen);
-                hash(m_first, m_last, mHash.begin());
+            /**
+             * \brief try_verify_hash without allocating
+             * \param workspace workspace_size(emLen) octets, contents on return are unspecified
+             */
+            static status try_verify_hash(const uint8_t* mHash, const uint8_t* em, size_t emLen, size_t emBits, uint8_t* workspace) noexcept
+            {
+                const size_t hLen  = Digest::size;
+                const size_t zBits = 8 * emLen - emBits;
 
                 //////////////////////////////////////////////////////////////////
                 // 3.  If emLen < hLen + sLen + 2, output "inconsistent" and stop.
-                if (emLen < hLen + sLen + 2)
+                if (emLen != (emBits + 7) / 8 || emLen < hLen + sLen + 2)
                 {
-                    throw std::runtime_error("inconsistent");
+                    return status::inconsistent;
                 }
 
                 /////////////////////////////////////////////////////////////////////////
                 // 4.  If the rightmost octet of EM does not have hexadecimal value 0xbc,
                 // output "inconsistent" and stop.
-                if (*(em_last - 1) != 0xbc)
+                if (em[emLen - 1] != 0xbc)
                 {
-                    throw std::runtime_error("inconsistent");
+                    return status::inconsistent;
                 }
 
                 ///////////////////////////////////////////////////////////////////
                 // 5.  Let maskedDB be the leftmost emLen - hLen - 1 octets of EM,
                 // and let H be the next hLen octets.
-                const size_t dbLen = emLen - hLen - 1;
-                std::vector<uint8_t> maskedDB(em_first, em_first + dbLen);
-
-                std::vector<uint8_t> H(em_first + dbLen, em_first + dbLen + hLen);
+                const size_t dbLen      = emLen - hLen - 1;
+                const uint8_t* maskedDB = em;
+                const uint8_t* H        = em + dbLen;
 
                 ///////////////////////////////////////////////////////////////////////////////////////////////////////
                 // 6. If the leftmost 8emLen - emBits bits of the leftmost octet in maskedDB are not all equal to zero,
                 // output "inconsistent" and stop.
-                if (zBits > 0)
-                    if (*maskedDB.begin() & (0xFF << zBits)) // (EM[0] & (0xFF << MSBits))
+                if (zBits > 0 && (maskedDB[0] & ~(0xFF >> zBits) & 0xFF))
+                {
+                    return status::inconsistent;
+                }
+
+                try
+                {
+                    // workspace = M' || DB
+                    uint8_t* M_ = workspace;
+                    uint8_t* DB = M_ + 8 + hLen + sLen;
+
+                    /////////////////////////////////////////////
+                    // 7. Let dbMask = MGF(H, emLen - hLen - 1).
+                    //
+                    // 8. Let DB = maskedDB \xor dbMask.
+                    MGFType mgf;
+
+                    std::copy(maskedDB, maskedDB + dbLen, DB);
+                    mgf.mask(H, H + hLen, DB, dbLen);
+
+                    ////////////////////////////////////////////////////////////////////////////////
+                    // 9. Set the leftmost 8emLen - emBits bits of the leftmost octet in DB to zero.
+                    if (zBits > 0)
+                        DB[0] &= (0xFF >> zBits);
+
+                    /////////////////////////////////////////////////////////////////////////
+                    // 10. If the emLen - hLen - sLen - 2 leftmost octets of DB are not zero
+                    // or if the octet at position emLen - hLen - sLen - 1 (the leftmost
+                    // position is "position 1") does not have hexadecimal value 0x01,
+                    // output "inconsistent" and stop.
+                    const size_t psLen = emLen - hLen - sLen - 2;
+                    if (std::any_of(DB, DB + psLen, [](uint8_t x) { return x != 0x00; }) || DB[psLen] != 0x01)
                     {
-                        throw std::runtime_error("inconsistent");
+                        return status::inconsistent;
                     }
 
-                /////////////////////////////////////////////
-                // 7. Let dbMask = MGF(H, emLen - hLen - 1).
-                std::vector<uint8_t> dbMask(dbLen);
+                    ////////////////////////////////////////////////////////////////
+                    // 11. Let salt be the last sLen octets of DB.
+                    //
+                    // 12. Let  M' = (0x)00 00 00 00 00 00 00 00 || mHash || salt ;
+                    // M' is an octet string of length 8 + hLen + sLen with eight initial zero octets.
+                    std::fill_n(M_, 8, 0x00);
+                    std::copy(DB + dbLen - sLen, DB + dbLen, std::copy(mHash, mHash + hLen, M_ + 8));
 
-                Digest mgf;
-                mgf(H.begin(), H.end(), dbMask.begin()/*, dbLen*/);
+                    /////////////////////////////////////////////////////////////
+                    // 13. Let H' = Hash(M'), 14. consistent iff H = H'
+                    uint8_t H_[Digest::size];
+                    Digest()(M_, M_ + 8 + hLen + sLen, H_);
 
-                /////////////////////////////////////
-                // 8. Let DB = maskedDB \xor dbMask.
-                std::vector<uint8_t> DB(dbLen);
-                std::transform(maskedDB.begin(), maskedDB.end(), dbMask.begin(), DB.begin(), std::bit_xor<>());
-
-                ////////////////////////////////////////////////////////////////////////////////
-                // 9. Set the leftmost 8emLen - emBits bits of the leftmost octet in DB to zero.
-                if (zBits > 0)
-                    *DB.begin() &= (0xFF >> (8 - zBits)); // DB[0] &= 0xFF >> (8 - MSBits);
-
-                /////////////////////////////////////////////////////////////////////////
-                // 10. If the emLen - hLen - sLen - 2 leftmost octets of DB are not zero
-                // or if the octet at position emLen - hLen - sLen - 1 (the leftmost
-                // position is "position 1") does not have hexadecimal value 0x01,
-                // output "inconsistent" and stop.
-                size_t i = 0;
-                for (; DB[i] == 0x00 && i < dbLen - 1; ++i)
-                    ;
-
-                if (DB[i] != 0x01)
+                    return std::equal(H, H + hLen, H_) ? status::ok : status::inconsistent;
+                }
+                catch (...)
                 {
-                    throw std::runtime_error("inconsistent");
+                    return status::internal_error;
                 }
-
-                //////////////////////////////////////////////////
-                // 11. Let salt be the em_last sLen octets of DB.
-                auto sIt = DB.end();
-                std::advance(sIt, -sLen);
-
-                std::vector<uint8_t> salt(sIt, DB.end());
-
-                ////////////////////////////////////////////////////////////////
-                // 12. Let  M' = (0x)00 00 00 00 00 00 00 00 || mHash || salt ;
-                // M' is an octet string of length 8 + hLen + sLen with eight initial zero octets.
-                std::vector<uint8_t> M_;
-                M_.reserve(8 + hLen + sLen);
-
-                ///////////////////////////////
-                // (0x)00 00 00 00 00 00 00 00
-                std::fill_n(std::back_inserter(M_), 8, 0);
-
-                /////////
-                // mHash
-                std::copy(mHash.begin(), mHash.end(), std::back_inserter(M_));
-
-                ////////
-                // salt
-                std::copy(salt.begin(), salt.end(), std::back_inserter(M_));
-
-                std::vector<uint8_t> H_;
-                H_.reserve(hLen);
-
-                hash(M_.begin(), M_.end(), std::back_inserter(H_));
-
-                return (H == H_);
             }
         };
     } // namespace rsa
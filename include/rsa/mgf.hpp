@@ -1,59 +1,82 @@
 #ifndef MGF_H
 #define MGF_H
 
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+
 namespace cry
 {
 
     namespace rsa
     {
+        /**
+         * \brief MGF1, RFC 8017 B.2.1
+         *
+         * The seed is absorbed once, every output block Hash(mgfSeed || C) is finished from a copy of that state.
+         * This relies on Digest being copyable with the copy a complete midstate, as the sha* classes are:
+         * their whole state is plain arrays and counters.
+         */
         template <class Digest>
         struct mgf1
         {
+            /**
+             * \brief writes the maskLen octets of MGF1(mgfSeed) to result
+             */
             template <class InputIterator, class OutputIterator>
             void operator()(InputIterator first, InputIterator last, OutputIterator result, size_t maskLen) const
             {
+                generate(first, last, maskLen, [&result](const uint8_t* block, size_t len) { result = std::copy_n(block, len, result); });
+            }
+
+            /**
+             * \brief XORs the maskLen octets of MGF1(mgfSeed) into target in place
+             */
+            template <class InputIterator>
+            void mask(InputIterator first, InputIterator last, uint8_t* target, size_t maskLen) const
+            {
+                generate(first, last, maskLen, [&target](const uint8_t* block, size_t len) {
+                    for (size_t i = 0; i != len; ++i)
+                    {
+                        *target++ ^= block[i];
+                    }
+                });
+            }
 
+          private:
+            template <class InputIterator, class Sink>
+            static void generate(InputIterator first, InputIterator last, size_t maskLen, Sink sink)
+            {
                 if (maskLen > 0xffffffff)
                 {
                     throw std::runtime_error("mask too long");
                 }
 
                 const size_t hLen = Digest::size;
-                Digest digest;
 
-                size_t i    = 0;
-                size_t rest = maskLen;
-                for (; i < maskLen / hLen; ++i)
-                {
-
-                    std::vector<uint8_t> mgfSeed(first, last);
-
-                    mgfSeed.push_back(static_cast<uint8_t>((i & 0xFF000000) >> 24));
-                    mgfSeed.push_back(static_cast<uint8_t>((i & 0x00FF0000) >> 16));
-                    mgfSeed.push_back(static_cast<uint8_t>((i & 0x0000FF00) >> 8));
-                    mgfSeed.push_back(static_cast<uint8_t>((i & 0x000000FF) >> 0));
+                Digest seeded;
+                seeded.Init();
+                seeded.Update(first, last);
 
-                    digest(mgfSeed.begin(), mgfSeed.end(), result);
-
-                    result += hLen;
-                    rest -= hLen;
-                }
+                uint8_t hash[Digest::size];
 
+                for (uint32_t i = 0; maskLen > 0; ++i)
                 {
-                    std::vector<uint8_t> mgfSeed(first, last);
+                    const uint8_t C[4] = { static_cast<uint8_t>(i >> 24), static_cast<uint8_t>(i >> 16), static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i) };
+
+                    Digest digest(seeded);
+                    digest.Update(C, C + 4);
+                    digest.Final(hash);
 
-                    mgfSeed.push_back(static_cast<uint8_t>((i & 0xFF000000) >> 24));
-                    mgfSeed.push_back(static_cast<uint8_t>((i & 0x00FF0000) >> 16));
-                    mgfSeed.push_back(static_cast<uint8_t>((i & 0x0000FF00) >> 8));
-                    mgfSeed.push_back(static_cast<uint8_t>((i & 0x000000FF) >> 0));
+                    const size_t len = std::min(maskLen, hLen);
+                    sink(hash, len);
 
-                    std::vector<uint8_t> hash(hLen);
-                    digest(mgfSeed.begin(), mgfSeed.end(), hash.begin());
-                    std::copy_n(hash.begin(), rest, result);
+                    maskLen -= len;
                 }
             }
         };
     }
 }
 
-#endif
\ No newline at end of file
+#endif
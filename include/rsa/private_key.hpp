@@ -0,0 +1,365 @@
+#ifndef RSA_PRIVATE_KEY_HPP
+#define RSA_PRIVATE_KEY_HPP
+
+#include "algorithm.hpp"
+#include "basic_integer.hpp"
+#include "blinding.hpp"
+#include "public_key.hpp"
+#include "utility/worker_pool.hpp"
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace cry
+{
+    namespace rsa
+    {
+        /**
+         * \brief RSA private key in the quintuple form of RFC 8017, 3.2 (p > q), with the per-key precomputation cached on first use
+         *
+         * A multi-prime key keeps its third and further primes in others, with the exponents and
+         * CRT coefficients of RFC 8017, 3.2: d_i = d mod (r_i - 1), t_i = (r_1 * ... * r_(i-1))^(-1) mod r_i.
+         *
+         * rsadp blinds every operation with a cached pair, see blinding and set_blinding. Blinding needs e:
+         * a key filled in by hand without it (e == 0) runs the CRT unblinded.
+         *
+         * The cached bit length, reduction contexts and blinding pairs are built from the fields on first use and
+         * are not rebuilt when a field changes: a key must not be modified after first use, or invalidate must be
+         * called once it has been. Copies and assignments start with empty caches.
+         * \tparam Integer integer type
+         */
+        template <class Integer = bigint_t>
+        struct private_key
+        {
+            Integer n;
+            Integer e;
+            Integer d;
+
+            Integer p;
+            Integer q;
+            Integer dP;   // d mod (p - 1)
+            Integer dQ;   // d mod (q - 1)
+            Integer qInv; // q^(-1) mod p
+
+            struct prime_info
+            {
+                Integer r;
+                Integer d;
+                Integer t;
+            };
+
+            std::vector<prime_info> others; // r_i, d_i, t_i for i = 3, ..., u
+
+            /**
+             * \brief number of primes, u
+             */
+            size_t primes() const noexcept
+            {
+                return 2 + others.size();
+            }
+
+            /**
+             * \brief modulus length in bits
+             */
+            size_t bits() const
+            {
+                return cache().bits;
+            }
+
+            /**
+             * \brief modulus length in octets, k
+             */
+            size_t size() const
+            {
+                return (bits() + 7) / 8;
+            }
+
+            /**
+             * \brief reduction contexts for p and q, built on first use
+             */
+            const montgomery_context<Integer>& context_p() const
+            {
+                return cache().p;
+            }
+
+            const montgomery_context<Integer>& context_q() const
+            {
+                return cache().q;
+            }
+
+            /**
+             * \brief reduction context for others[i].r
+             */
+            const montgomery_context<Integer>& context_other(size_t i) const
+            {
+                return cache().others[i];
+            }
+
+            /**
+             * \brief drops the cached precomputation and blinding pairs, to be called after changing a field of a key
+             * already in use; not while another thread uses the key
+             */
+            void invalidate()
+            {
+                m_Cache    = lazy_value<cache_type>();
+                m_Blinding = lazy_value<rsa::blinding<Integer>>();
+            }
+
+            /**
+             * \brief configures blinding of the private-key operation
+             * \param refresh operations per random r, in between the pair is squared; 0 - no blinding
+             * \param reserve fresh pairs kept ready by worker_pool::shared()
+             */
+            void set_blinding(size_t refresh, size_t reserve = 2)
+            {
+                m_BlindingRefresh = refresh;
+                m_BlindingReserve = reserve;
+                m_Blinding        = lazy_value<rsa::blinding<Integer>>();
+            }
+
+            /**
+             * \brief "TRUE" if rsadp blinds: blinding is not switched off and the key has its public exponent
+             */
+            bool blinded() const noexcept
+            {
+                return m_BlindingRefresh != 0 && static_cast<bool>(e);
+            }
+
+            /**
+             * \brief blinding pairs for n and e, built on first use; throws std::logic_error if e is not set
+             */
+            const rsa::blinding<Integer>& blinding() const
+            {
+                return m_Blinding.get([this] { return rsa::blinding<Integer>(n, e, m_BlindingRefresh, m_BlindingReserve); });
+            }
+
+          private:
+            struct cache_type
+            {
+                size_t bits;
+                montgomery_context<Integer> p;
+                montgomery_context<Integer> q;
+                std::vector<montgomery_context<Integer>> others;
+            };
+
+            const cache_type& cache() const
+            {
+                return m_Cache.get([this] {
+                    cache_type c{ bit_length(n), montgomery_context<Integer>(p), montgomery_context<Integer>(q), {} };
+
+                    c.others.reserve(others.size());
+                    for (const auto& info : others)
+                    {
+                        c.others.emplace_back(info.r);
+                    }
+
+                    return c;
+                });
+            }
+
+            lazy_value<cache_type> m_Cache;
+
+            size_t m_BlindingRefresh = 32;
+            size_t m_BlindingReserve = 2;
+            lazy_value<rsa::blinding<Integer>> m_Blinding;
+        };
+
+        /**
+         * \brief how rsadp schedules the per-prime exponentiations
+         */
+        enum class crt_mode
+        {
+            sequential, // one after the other on the calling thread
+            parallel    // the exponentiations modulo p, q and the other primes run on worker_pool::shared() alongside the caller
+        };
+
+        /**
+         * \brief builds the private key from distinct primes and the public exponent
+         * \param primes r_1, ..., r_u, u >= 2; the larger of the first two becomes p
+         * \return returns "FALSE" if the primes are not distinct or e is not invertible modulo (r_1 - 1) * ... * (r_u - 1)
+         */
+        template <class Integer>
+        bool make_private_key(private_key<Integer>& key, std::vector<Integer> primes, const Integer& e)
+        {
+            if (primes.size() < 2)
+            {
+                throw std::logic_error("at least two primes are required");
+            }
+
+            for (size_t i = 0; i != primes.size(); ++i)
+            {
+                for (size_t j = i + 1; j != primes.size(); ++j)
+                {
+                    if (primes[i] == primes[j])
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            if (primes[0] < primes[1])
+            {
+                std::swap(primes[0], primes[1]);
+            }
+
+            Integer n   = 1;
+            Integer phi = 1;
+            for (const auto& r : primes)
+            {
+                n *= r;
+                phi *= r - 1;
+            }
+
+            Integer d;
+            if (!cry::mod_inverse(d, e % phi, phi))
+            {
+                return false;
+            }
+
+            Integer qInv;
+            if (!cry::mod_inverse(qInv, primes[1], primes[0]))
+            {
+                return false;
+            }
+
+            private_key<Integer> result;
+
+            //////////////////////////////////////////////////////////
+            // r_i, d_i = d mod (r_i - 1), t_i = (r_1 * ... * r_(i-1))^(-1) mod r_i
+            Integer R = primes[0] * primes[1];
+            for (size_t i = 2; i != primes.size(); ++i)
+            {
+                typename private_key<Integer>::prime_info info;
+
+                if (!cry::mod_inverse(info.t, R % primes[i], primes[i]))
+                {
+                    return false;
+                }
+
+                info.d = d % (primes[i] - 1);
+                R *= primes[i];
+                info.r = std::move(primes[i]);
+
+                result.others.push_back(std::move(info));
+            }
+
+            result.n    = std::move(n);
+            result.e    = e;
+            result.dP   = d % (primes[0] - 1);
+            result.dQ   = d % (primes[1] - 1);
+            result.d    = std::move(d);
+            result.p    = std::move(primes[0]);
+            result.q    = std::move(primes[1]);
+            result.qInv = std::move(qInv);
+
+            // assignment drops whatever contexts the old key had cached
+            key = std::move(result);
+
+            return true;
+        }
+
+        /**
+         * \brief builds the two-prime private key
+         * \return returns "FALSE" if p == q or e is not invertible modulo (p - 1) * (q - 1)
+         */
+        template <class Integer>
+        bool make_private_key(private_key<Integer>& key, Integer p, Integer q, const Integer& e)
+        {
+            std::vector<Integer> primes;
+            primes.reserve(2);
+            primes.push_back(std::move(p));
+            primes.push_back(std::move(q));
+
+            return make_private_key(key, std::move(primes), e);
+        }
+
+        /**
+         * \brief RSADP / RSASP1 with the CRT private key: one exponentiation per prime and Garner's recombination,
+         * blinded unless key.blinded() is "FALSE"
+         * \param key private key
+         * \param c representative, 0 <= c < n
+         * \param mode sequential or parallel halves, see crt_mode
+         * \return c^d mod n
+         */
+        template <class Integer>
+        Integer rsadp(const private_key<Integer>& key, const Integer& c, crt_mode mode = crt_mode::sequential)
+        {
+            if (c >= key.n)
+            {
+                throw std::runtime_error("representative out of range");
+            }
+
+            auto crt = [&key, mode](const Integer& x) -> Integer {
+                ///////////////////////////////////////////////////////////////
+                // 1. m_i = x^d_i mod r_i: m_1 with p and dP, m_2 with q and dQ
+                std::vector<Integer> m(key.primes());
+
+                auto exponentiate = [&](size_t i) {
+                    if (i == 0)
+                    {
+                        m[0] = key.context_p().pow(x % key.p, key.dP);
+                    }
+                    else if (i == 1)
+                    {
+                        m[1] = key.context_q().pow(x % key.q, key.dQ);
+                    }
+                    else
+                    {
+                        const auto& info = key.others[i - 2];
+                        m[i]             = key.context_other(i - 2).pow(x % info.r, info.d);
+                    }
+                };
+
+                if (mode == crt_mode::parallel)
+                {
+                    worker_pool::shared().parallel_for(m.size(), exponentiate);
+                }
+                else
+                {
+                    for (size_t i = 0; i != m.size(); ++i)
+                    {
+                        exponentiate(i);
+                    }
+                }
+
+                ///////////////////////////////////////////////
+                // 2. h = (m_1 - m_2) * qInv mod p, q may be larger than p, so m_2 is reduced first
+                Integer h = (m[0] + key.p - m[1] % key.p) % key.p;
+
+                h *= key.qInv;
+                h %= key.p;
+
+                ///////////////////////
+                // 3. m = m_2 + q * h
+                Integer result = m[1] + key.q * h;
+
+                /////////////////////////////////////////////////////////////////////////////
+                // 4. Garner for i = 3, ..., u: R = r_1 * ... * r_(i-1), h = (m_i - m) * t_i mod r_i, m = m + R * h
+                Integer R = key.p * key.q;
+                for (size_t i = 2; i != m.size(); ++i)
+                {
+                    const auto& info = key.others[i - 2];
+
+                    h = m[i] - result % info.r;
+                    if (h < 0)
+                    {
+                        h += info.r;
+                    }
+
+                    h *= info.t;
+                    h %= info.r;
+
+                    result += R * h;
+                    R *= info.r;
+                }
+
+                return result;
+            };
+
+            return key.blinded() ? key.blinding().apply(c, crt) : crt(c);
+        }
+    } // namespace rsa
+} // namespace cry
+
+#endif // RSA_PRIVATE_KEY_HPP
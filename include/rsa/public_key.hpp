@@ -0,0 +1,160 @@
+#ifndef RSA_PUBLIC_KEY_HPP
+#define RSA_PUBLIC_KEY_HPP
+
+#include "algorithm.hpp"
+#include "basic_integer.hpp"
+
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace cry
+{
+    namespace rsa
+    {
+        /**
+         * \brief value built on first access, at most once even under concurrent access
+         *
+         * Copies and assignments start empty, so a key that is copied or reassigned never
+         * carries contexts built for other parameters.
+         */
+        template <class T>
+        class lazy_value
+        {
+          public:
+            lazy_value() : m_State(new state_type)
+            {
+            }
+
+            lazy_value(const lazy_value&) : lazy_value()
+            {
+            }
+
+            lazy_value& operator=(const lazy_value&)
+            {
+                m_State.reset(new state_type);
+                return *this;
+            }
+
+            template <class Factory>
+            const T& get(Factory&& factory) const
+            {
+                std::call_once(m_State->once, [&] { m_State->value.reset(new T(factory())); });
+                return *m_State->value;
+            }
+
+          private:
+            struct state_type
+            {
+                std::once_flag once;
+                std::unique_ptr<const T> value;
+            };
+
+            std::unique_ptr<state_type> m_State;
+        };
+
+        /**
+         * \brief RSA public key (n, e) with the per-key precomputation cached on first use
+         *
+         * The cache is built from n and e on first use and is not rebuilt when they change: a key must not be
+         * modified after first use, or invalidate must be called once it has been.
+         * \tparam Integer integer type
+         */
+        template <class Integer = bigint_t>
+        struct public_key
+        {
+            Integer n;
+            Integer e;
+
+            public_key() = default;
+
+            public_key(Integer modulus, Integer exponent) : n(std::move(modulus)), e(std::move(exponent))
+            {
+            }
+
+            /**
+             * \brief modulus length in bits
+             */
+            size_t bits() const
+            {
+                return cache().bits;
+            }
+
+            /**
+             * \brief modulus length in octets, k
+             */
+            size_t size() const
+            {
+                return (bits() + 7) / 8;
+            }
+
+            /**
+             * \brief calculates m^e mod n, through the single-word exponent path for e = 3, 17, 65537 and the like
+             */
+            Integer pow(const Integer& m) const
+            {
+                const cache_type& c = cache();
+
+                return c.small_e ? c.n.pow(m, c.e_word) : c.n.pow(m, e);
+            }
+
+            /**
+             * \brief reduction context for n
+             */
+            const montgomery_context<Integer>& context() const
+            {
+                return cache().n;
+            }
+
+            /**
+             * \brief drops the cached precomputation, to be called after changing n or e of a key already in use;
+             * not while another thread uses the key
+             */
+            void invalidate()
+            {
+                m_Cache = lazy_value<cache_type>();
+            }
+
+          private:
+            struct cache_type
+            {
+                size_t bits;
+                montgomery_context<Integer> n;
+                bool small_e;
+                uint32_t e_word;
+            };
+
+            const cache_type& cache() const
+            {
+                return m_Cache.get([this] {
+                    uint32_t word = 0;
+                    const bool small = to_word(e, word);
+
+                    return cache_type{ bit_length(n), montgomery_context<Integer>(n), small, word };
+                });
+            }
+
+            lazy_value<cache_type> m_Cache;
+        };
+
+        /**
+         * \brief RSAEP / RSAVP1
+         * \param key public key
+         * \param m representative, 0 <= m < n
+         * \return m^e mod n
+         */
+        template <class Integer>
+        Integer rsaep(const public_key<Integer>& key, const Integer& m)
+        {
+            if (m >= key.n)
+            {
+                throw std::runtime_error("representative out of range");
+            }
+
+            return key.pow(m);
+        }
+    } // namespace rsa
+} // namespace cry
+
+#endif // RSA_PUBLIC_KEY_HPP
@@ -8,6 +8,12 @@
 #include <algorithm.hpp>
 
 #include "basic_integer.hpp"
+#include "private_key.hpp"
+#include "utility/worker_pool.hpp"
+
+#include <functional>
+#include <stdexcept>
+#include <vector>
 
 namespace cry
 {
@@ -45,11 +51,8 @@ namespace cry
             {
                 T p, q;
 
-                std::thread pThread(cry::generate_probably_prime<T>, std::ref(p), modulusbits / 2, e);
-                std::thread qThread(cry::generate_probably_prime<T>, std::ref(q), modulusbits / 2, e);
-
-                pThread.join();
-                qThread.join();
+                worker_pool::shared().invoke([&] { cry::generate_probably_prime<T>(p, modulusbits / 2, e); },
+                                             [&] { cry::generate_probably_prime<T>(q, modulusbits / 2, e); });
 
                 T N   = p * q;
                 T Phi = (p - 1) * (q - 1);
@@ -64,6 +67,87 @@ namespace cry
                 }
             }
         }
+
+        namespace
+        {
+            /**
+             * \brief bit length of the i-th of nprimes factors: generate_probably_prime works in whole octets,
+             * so the octets of the modulus are spread over the factors, the remainder going to the first ones
+             */
+            inline uint32_t prime_bits(uint32_t modulusbits, size_t nprimes, size_t i)
+            {
+                const uint32_t nbytes = modulusbits / 8;
+
+                return 8 * static_cast<uint32_t>(nbytes / nprimes + (i < nbytes % nprimes ? 1 : 0));
+            }
+
+            template <class T>
+            bool make_generated_key(private_key<T>& key, std::vector<T>& primes, uint32_t e, uint32_t modulusbits)
+            {
+                // with three or more factors the product can come out one bit short
+                T n = 1;
+                for (const auto& r : primes)
+                {
+                    n *= r;
+                }
+
+                return bit_length(n) == modulusbits / 8 * 8 && make_private_key(key, std::move(primes), T(e));
+            }
+        }
+
+        /**
+         * \brief generates the private key in the CRT form
+         * \tparam T integer type
+         * \param key result
+         * \param e public exponent
+         * \param modulusbits modulus length
+         * \param nprimes number of prime factors, 2 or a multi-prime key of RFC 8017 with 3 or 4
+         */
+        template <class T>
+        void generate_key_pair(private_key<T>& key, uint32_t e, uint32_t modulusbits, size_t nprimes = 2)
+        {
+            if (nprimes < 2)
+            {
+                throw std::logic_error("at least two primes are required");
+            }
+
+            for (;;)
+            {
+                std::vector<T> primes(nprimes);
+                for (size_t i = 0; i != nprimes; ++i)
+                {
+                    cry::generate_probably_prime<T>(std::ref(primes[i]), prime_bits(modulusbits, nprimes, i), e);
+                }
+
+                if (make_generated_key(key, primes, e, modulusbits))
+                {
+                    break;
+                }
+            }
+        }
+
+        /**
+         * \brief generates the private key in the CRT form, the prime factors in parallel on worker_pool::shared()
+         */
+        template <class T>
+        void generate_key_pair_mt(private_key<T>& key, uint32_t e, uint32_t modulusbits, size_t nprimes = 2)
+        {
+            if (nprimes < 2)
+            {
+                throw std::logic_error("at least two primes are required");
+            }
+
+            for (;;)
+            {
+                std::vector<T> primes(nprimes);
+                worker_pool::shared().parallel_for(nprimes, [&](size_t i) { cry::generate_probably_prime<T>(primes[i], prime_bits(modulusbits, nprimes, i), e); });
+
+                if (make_generated_key(key, primes, e, modulusbits))
+                {
+                    break;
+                }
+            }
+        }
     }
 }
 
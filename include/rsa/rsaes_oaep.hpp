@@ -8,6 +8,8 @@
 #include "algorithm.hpp"
 #include "basic_integer.hpp"
 #include "eme_oaep.hpp"
+#include "private_key.hpp"
+#include "status.hpp"
 #include "utility/os2ip.hpp"
 
 namespace cry
@@ -33,6 +35,78 @@ namespace cry
              */
             template <class InputIterator, class OutputIterator>
             static OutputIterator encrypt(InputIterator first, InputIterator last, OutputIterator result, const Integer& e, const Integer& n, size_t modBits, const std::vector<uint8_t>& seed = std::vector<uint8_t>(), const std::vector<uint8_t>& label = std::vector<uint8_t>())
+            {
+                return encrypt_with(first, last, result, modBits, seed, label, [&](const Integer& m) { return cry::pow_mod(m, e, n); });
+            }
+
+            /**
+             * \brief encrypts with the cached per-key contexts
+             * \param key public key, see rsa::public_key
+             */
+            template <class InputIterator, class OutputIterator>
+            static OutputIterator encrypt(InputIterator first, InputIterator last, OutputIterator result, const public_key<Integer>& key, const std::vector<uint8_t>& seed = std::vector<uint8_t>(), const std::vector<uint8_t>& label = std::vector<uint8_t>())
+            {
+                return encrypt_with(first, last, result, key.bits(), seed, label, [&](const Integer& m) { return rsaep(key, m); });
+            }
+
+            /**
+             * \brief
+             * \tparam InputIterator
+             * \tparam OutputIterator
+             * \param c_first
+             * \param c_last
+             * \param result
+             * \param d
+             * \param n
+             * \param modBits
+             * \return
+             */
+            template <class InputIterator, class OutputIterator>
+            static OutputIterator decrypt(InputIterator c_first, InputIterator c_last, OutputIterator result, const Integer& d, const Integer& n, size_t modBits)
+            {
+                return decrypt_with(c_first, c_last, result, n, modBits, [&](const Integer& c) { return cry::pow_mod(c, d, n); });
+            }
+
+            /**
+             * \brief decrypts with the CRT form of the private key
+             * \param key private key, see rsa::private_key
+             * \param mode see rsa::crt_mode
+             */
+            template <class InputIterator, class OutputIterator>
+            static OutputIterator decrypt(InputIterator c_first, InputIterator c_last, OutputIterator result, const private_key<Integer>& key, crt_mode mode = crt_mode::sequential)
+            {
+                return decrypt_with(c_first, c_last, result, key.n, key.bits(), [&](const Integer& c) { return rsadp(key, c, mode); });
+            }
+
+            /**
+             * \brief decrypts without throwing, for paths where failures are frequent
+             * \param c ciphertext, cLen octets
+             * \param out receives the message, capacity octets available
+             * \param mLen message length, set on status::ok
+             * \return status::decryption_error for every malformed ciphertext alike
+             */
+            static status try_decrypt(const uint8_t* c, size_t cLen, uint8_t* out, size_t capacity, size_t& mLen, const private_key<Integer>& key, crt_mode mode = crt_mode::sequential) noexcept
+            {
+                mLen = 0;
+
+                try
+                {
+                    return try_decrypt_with(c, cLen, out, capacity, mLen, key.n, key.bits(), [&](const Integer& x) { return rsadp(key, x, mode); });
+                }
+                catch (...)
+                {
+                    return status::internal_error;
+                }
+            }
+
+            static status try_decrypt(const uint8_t* c, size_t cLen, uint8_t* out, size_t capacity, size_t& mLen, const Integer& d, const Integer& n, size_t modBits) noexcept
+            {
+                return try_decrypt_with(c, cLen, out, capacity, mLen, n, modBits, [&](const Integer& x) { return cry::pow_mod(x, d, n); });
+            }
+
+          private:
+            template <class InputIterator, class OutputIterator, class Primitive>
+            static OutputIterator encrypt_with(InputIterator first, InputIterator last, OutputIterator result, size_t modBits, const std::vector<uint8_t>& seed, const std::vector<uint8_t>& label, Primitive primitive)
             {
                 const auto k = (modBits + 7) / 8;
 
@@ -53,7 +127,7 @@ namespace cry
                 // the message representative m to produce an integer ciphertext
                 // representative c :
 
-                Integer c = cry::pow_mod(m, e, n);
+                Integer c = primitive(m);
 
                 ///////////////////////////////////////////////////////////////////////////////////
                 // c. Convert the ciphertext representative c to a ciphertext C of length koctets
@@ -64,63 +138,68 @@ namespace cry
                 return result;
             }
 
-            /**
-             * \brief
-             * \tparam InputIterator
-             * \tparam OutputIterator
-             * \param c_first
-             * \param c_last
-             * \param result
-             * \param d
-             * \param n
-             * \param modBits
-             * \return
-             */
-            template <class InputIterator, class OutputIterator>
-            static OutputIterator decrypt(InputIterator c_first, InputIterator c_last, OutputIterator result, const Integer& d, const Integer& n, size_t modBits)
+            template <class InputIterator, class OutputIterator, class Primitive>
+            static OutputIterator decrypt_with(InputIterator c_first, InputIterator c_last, OutputIterator result, const Integer& n, size_t modBits, Primitive primitive)
             {
+                const std::vector<uint8_t> C(c_first, c_last);
+                std::vector<uint8_t> M((modBits + 7) / 8);
 
-                ///////////////////////
-                // 1. Length checking:
+                size_t mLen = 0;
+                throw_on_error(try_decrypt_with(C.data(), C.size(), M.data(), M.size(), mLen, n, modBits, primitive));
+
+                result = std::copy(M.begin(), M.begin() + mLen, result);
+
+                return result;
+            }
+
+            template <class Primitive>
+            static status try_decrypt_with(const uint8_t* c_first, size_t cLen, uint8_t* out, size_t capacity, size_t& mLen, const Integer& n, size_t modBits, Primitive primitive) noexcept
+            {
+                mLen = 0;
 
-                const auto k      = (modBits + 7) / 8;
-                const size_t cLen = std::distance(c_first, c_last);
+                const size_t k = (modBits + 7) / 8;
 
-                ////////////////////////////////////////////////////////////////////////////////////////////
-                // b. If the length of the ciphertext C is not k octets, output �decryption error� and stop.
-                if (cLen != k)
+                ///////////////////////////////////////////////////////////////////////////////////////////
+                // 1. If the length of the ciphertext C is not k octets, or if k < 2hLen + 2,
+                // output "decryption error" and stop.
+                if (cLen != k || k < 2 * hLen + 2)
                 {
-                    throw std::runtime_error("decryption error");
+                    return status::decryption_error;
                 }
 
-                ///////////////////////////////////////////////////////////
-                // c. If k < 2hLen + 2, output �decryption error� and stop.
-                if (k < 2 * hLen + 2)
+                try
                 {
-                    throw std::runtime_error("decryption error");
+                    //////////////////////////////////////////////////////////////////////////////////////////
+                    // 2a. Convert the ciphertext C to an integer ciphertext representative c, which must be < n
+                    const Integer c = OS2IP<Integer>()(c_first, c_first + cLen);
+                    if (c >= n)
+                    {
+                        return status::decryption_error;
+                    }
+
+                    //////////////////////////////////////////////////////////////////////////////////////
+                    // 2b. Apply the RSADP decryption primitive to produce an integer message representative m
+                    const Integer m = primitive(c);
+
+                    ///////////////////////////////////////////////////////////////////////////////
+                    // 2c. Convert the message representative m to an encoded message EM of k octets
+                    // EM || workspace, reused by every decryption on this thread
+                    thread_local std::vector<uint8_t> EM;
+                    EM.resize(k + eme_oaep<Digest, MGFType, hLen>::workspace_size(k));
+
+                    if (!I2OSP_fixed(m, EM.data(), k))
+                    {
+                        return status::decryption_error;
+                    }
+
+                    ///////////////////////////
+                    // 3. EME - OAEP decoding:
+                    return eme_oaep<Digest, MGFType, hLen>::try_decode(EM.data(), k, out, capacity, mLen, nullptr, 0, EM.data() + k);
+                }
+                catch (...)
+                {
+                    return status::internal_error;
                 }
-
-                //////////////////////
-                // 2. RSA decryption:
-
-                /////////////////////////////////////////////////////////////////////////
-                // a. Convert the ciphertext C to an integer ciphertext representative c
-                const Integer c = OS2IP<Integer>()(c_first, c_last);
-
-                //////////////////////////////////////////////////////////////////////////////
-                // b. Apply the RSADP decryption primitive to the RSA private key K and the
-                // ciphertext representative c to produce an integer message representative m:
-                const Integer m = cry::pow_mod(c, d, n);
-
-                ////////////////////////////////////////////////////////////////////////////////////////
-                // c. Convert the message representative m to an encoded message EM of length k octets:
-                const std::vector<uint8_t> EM = I2OSP<Integer>()(m);
-
-                ///////////////////////////
-                // 3. EME - OAEP decoding:
-                result = eme_oaep<Digest, MGFType, hLen>::decode(EM.begin(), EM.end(), result, k);
-
-                return result;
             }
         };
     } // namespace rsa
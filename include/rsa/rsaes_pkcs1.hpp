@@ -8,6 +8,8 @@
 #include "algorithm.hpp"
 #include "basic_integer.hpp"
 #include "eme_pkcs1.hpp"
+#include "private_key.hpp"
+#include "status.hpp"
 #include "utility/os2ip.hpp"
 
 namespace cry
@@ -31,6 +33,78 @@ namespace cry
              */
             template <class InputIterator, class OutputIterator>
             static OutputIterator encrypt(InputIterator first, InputIterator last, OutputIterator result, const Integer& e, const Integer& n, size_t modBits)
+            {
+                return encrypt_with(first, last, result, modBits, [&](const Integer& m) { return cry::pow_mod(m, e, n); });
+            }
+
+            /**
+             * \brief encrypts with the cached per-key contexts
+             * \param key public key, see rsa::public_key
+             */
+            template <class InputIterator, class OutputIterator>
+            static OutputIterator encrypt(InputIterator first, InputIterator last, OutputIterator result, const public_key<Integer>& key)
+            {
+                return encrypt_with(first, last, result, key.bits(), [&](const Integer& m) { return rsaep(key, m); });
+            }
+
+            /**
+             * \brief
+             * \tparam InputIterator
+             * \tparam OutputIterator
+             * \param first
+             * \param last
+             * \param result
+             * \param d
+             * \param n
+             * \param modBits
+             * \return
+             */
+            template <class InputIterator, class OutputIterator>
+            static OutputIterator decrypt(InputIterator first, InputIterator last, OutputIterator result, const Integer& d, const Integer& n, size_t modBits)
+            {
+                return decrypt_with(first, last, result, n, modBits, [&](const Integer& c) { return cry::pow_mod(c, d, n); });
+            }
+
+            /**
+             * \brief decrypts with the CRT form of the private key
+             * \param key private key, see rsa::private_key
+             * \param mode see rsa::crt_mode
+             */
+            template <class InputIterator, class OutputIterator>
+            static OutputIterator decrypt(InputIterator first, InputIterator last, OutputIterator result, const private_key<Integer>& key, crt_mode mode = crt_mode::sequential)
+            {
+                return decrypt_with(first, last, result, key.n, key.bits(), [&](const Integer& c) { return rsadp(key, c, mode); });
+            }
+
+            /**
+             * \brief decrypts without throwing, for paths where failures are frequent
+             * \param c ciphertext, cLen octets
+             * \param out receives the message, capacity octets available
+             * \param mLen message length, set on status::ok
+             * \return status::decryption_error for every malformed ciphertext alike
+             */
+            static status try_decrypt(const uint8_t* c, size_t cLen, uint8_t* out, size_t capacity, size_t& mLen, const private_key<Integer>& key, crt_mode mode = crt_mode::sequential) noexcept
+            {
+                mLen = 0;
+
+                try
+                {
+                    return try_decrypt_with(c, cLen, out, capacity, mLen, key.n, key.bits(), [&](const Integer& x) { return rsadp(key, x, mode); });
+                }
+                catch (...)
+                {
+                    return status::internal_error;
+                }
+            }
+
+            static status try_decrypt(const uint8_t* c, size_t cLen, uint8_t* out, size_t capacity, size_t& mLen, const Integer& d, const Integer& n, size_t modBits) noexcept
+            {
+                return try_decrypt_with(c, cLen, out, capacity, mLen, n, modBits, [&](const Integer& x) { return cry::pow_mod(x, d, n); });
+            }
+
+          private:
+            template <class InputIterator, class OutputIterator, class Primitive>
+            static OutputIterator encrypt_with(InputIterator first, InputIterator last, OutputIterator result, size_t modBits, Primitive primitive)
             {
                 const auto k = (modBits + 7) / 8;
 
@@ -45,7 +119,7 @@ namespace cry
 
                 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
                 // 3. Apply the RSAEP encryption primitive to the public key(n, e) and the message representative m to produce an integer ciphertext representative c:
-                const Integer c = cry::pow_mod(m, e, n);
+                const Integer c = primitive(m);
 
                 ///////////////////////////////////////////////////////////////////////////////////
                 // 4. Convert the ciphertext representative c to a ciphertext C of length k octets
@@ -56,48 +130,64 @@ namespace cry
                 return result;
             }
 
-            /**
-             * \brief
-             * \tparam InputIterator
-             * \tparam OutputIterator
-             * \param first
-             * \param last
-             * \param result
-             * \param d
-             * \param n
-             * \param modBits
-             * \return
-             */
-            template <class InputIterator, class OutputIterator>
-            static OutputIterator decrypt(InputIterator first, InputIterator last, OutputIterator result, const Integer& d, const Integer& n, size_t modBits)
+            template <class InputIterator, class OutputIterator, class Primitive>
+            static OutputIterator decrypt_with(InputIterator first, InputIterator last, OutputIterator result, const Integer& n, size_t modBits, Primitive primitive)
             {
-                const auto k = (modBits + 7) / 8;
+                const std::vector<uint8_t> C(first, last);
+                std::vector<uint8_t> M((modBits + 7) / 8);
 
-                ////////////////////////////////////////////////////////////////////////////////////////////
-                // 1. If the length of the ciphertext C is not k octets, output �decryption error� and stop.
-                auto cLen = std::distance(first, last);
-                if (cLen != k)
-                {
-                    throw std::runtime_error("decryption error");
-                }
+                size_t mLen = 0;
+                throw_on_error(try_decrypt_with(C.data(), C.size(), M.data(), M.size(), mLen, n, modBits, primitive));
 
-                /////////////////////////////////////////////////////////////////////////
-                // 2. Convert the ciphertext C to an integer ciphertext representative c:
-                const Integer c = OS2IP<Integer>()(first, last);
+                result = std::copy(M.begin(), M.begin() + mLen, result);
+
+                return result;
+            }
 
-                ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-                // 3. Apply the RSADP decryption primitive to the private key(n, d) and the ciphertext representative c to produce an integer message representative m:
-                const Integer m = cry::pow_mod(c, d, n);
+            template <class Primitive>
+            static status try_decrypt_with(const uint8_t* c_first, size_t cLen, uint8_t* out, size_t capacity, size_t& mLen, const Integer& n, size_t modBits, Primitive primitive) noexcept
+            {
+                mLen = 0;
 
-                /////////////////////////////////////////////////////////////////////////////////////////
-                // 4. Convert the message representative m to an encoded message EM of length k�1 octets:
-                const std::vector<uint8_t> EM = I2OSP<Integer>()(m);
+                const size_t k = (modBits + 7) / 8;
 
-				//////////////////////////////////////////////////
-				// 5. Apply EME - PKCS1 - v1_5 decoding operation
-                result = eme_pkcs1::decode(EM.begin(), EM.end(), result);
+                ///////////////////////////////////////////////////////////////////////////////////////////
+                // 1. If the length of the ciphertext C is not k octets, output "decryption error" and stop.
+                if (cLen != k || k < 11)
+                {
+                    return status::decryption_error;
+                }
 
-                return result;
+                try
+                {
+                    //////////////////////////////////////////////////////////////////////////////////////////
+                    // 2. Convert the ciphertext C to an integer ciphertext representative c, which must be < n
+                    const Integer c = OS2IP<Integer>()(c_first, c_first + cLen);
+                    if (c >= n)
+                    {
+                        return status::decryption_error;
+                    }
+
+                    //////////////////////////////////////////////////////////////////////////////////////
+                    // 3. Apply the RSADP decryption primitive to produce an integer message representative m
+                    const Integer m = primitive(c);
+
+                    ///////////////////////////////////////////////////////////////////////////////
+                    // 4. Convert the message representative m to an encoded message EM of k octets
+                    std::vector<uint8_t> EM(k);
+                    if (!I2OSP_fixed(m, EM.data(), k))
+                    {
+                        return status::decryption_error;
+                    }
+
+                    //////////////////////////////////////////////////
+                    // 5. Apply EME - PKCS1 - v1_5 decoding operation
+                    return eme_pkcs1::try_decode(EM.data(), k, out, capacity, mLen);
+                }
+                catch (...)
+                {
+                    return status::internal_error;
+                }
             }
         };
     } // namespace rsa
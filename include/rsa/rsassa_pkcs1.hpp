@@ -6,6 +6,9 @@
 #define RSASSA_PKCS1_HPP
 
 #include "basic_integer.hpp"
+#include "emsa_pkcs1.hpp"
+#include "private_key.hpp"
+#include "verify_batch.hpp"
 
 namespace cry
 {
@@ -15,6 +18,9 @@ namespace cry
         template <class DigestType = sha1, class Integer = bigint_t>
         struct rsassa_pkcs1
         {
+            class signer;
+            class verifier;
+
             /**
              * \brief
              * \tparam InputIterator
@@ -30,21 +36,37 @@ namespace cry
             template <class InputIterator, class OutputIterator>
             static OutputIterator sign(InputIterator first, InputIterator last, OutputIterator result, const Integer& d, const Integer& n, size_t modBits)
             {
-                const auto emLen = (modBits + 7) / 8;
-                std::vector<uint8_t> encoded(emLen);
+                return sign_with(first, last, result, modBits, [&](const Integer& m) { return cry::pow_mod(m, d, n); });
+            }
 
-				////////////////////////////////////////////////////
-				// Apply the EMSA - PKCS1 - v1_5 encoding operation
-                auto end = emsa_pkcs1<DigestType>::encode(first, last, encoded.begin(), emLen);
+            /**
+             * \brief signs with the CRT form of the private key
+             * \param key private key, see rsa::private_key
+             * \param mode see rsa::crt_mode
+             */
+            template <class InputIterator, class OutputIterator>
+            static OutputIterator sign(InputIterator first, InputIterator last, OutputIterator result, const private_key<Integer>& key, crt_mode mode = crt_mode::sequential)
+            {
+                return sign_with(first, last, result, key.bits(), [&](const Integer& m) { return rsadp(key, m, mode); });
+            }
 
-                const Integer arg = OS2IP<Integer>()(encoded.begin(), encoded.end());
-                const Integer s   = cry::pow_mod(arg, d, n);
+            /**
+             * \brief signs a precomputed DigestType(M) of DigestType::size octets, the message is not hashed again
+             */
+            template <class HInputIterator, class OutputIterator>
+            static OutputIterator sign_digest(HInputIterator h_first, HInputIterator h_last, OutputIterator result, const Integer& d, const Integer& n, size_t modBits)
+            {
+                const std::vector<uint8_t> hash = digest_of(h_first, h_last);
 
-                const std::vector<uint8_t> S = I2OSP<Integer>()(s);
+                return sign_digest_with(hash.data(), result, modBits, [&](const Integer& m) { return cry::pow_mod(m, d, n); });
+            }
 
-                result = std::copy(S.begin(), S.end(), result);
+            template <class HInputIterator, class OutputIterator>
+            static OutputIterator sign_digest(HInputIterator h_first, HInputIterator h_last, OutputIterator result, const private_key<Integer>& key, crt_mode mode = crt_mode::sequential)
+            {
+                const std::vector<uint8_t> hash = digest_of(h_first, h_last);
 
-                return result;
+                return sign_digest_with(hash.data(), result, key.bits(), [&](const Integer& m) { return rsadp(key, m, mode); });
             }
 
             /**
@@ -62,14 +84,112 @@ namespace cry
             template <class InputIterator>
             static bool verify(InputIterator s_first, InputIterator s_last, InputIterator m_first, InputIterator m_last, const Integer& e, const Integer& n, size_t modulusBits)
             {
+                return verify_with(s_first, s_last, m_first, m_last, n, modulusBits, [&](const Integer& s) { return cry::pow_mod(s, e, n); });
+            }
+
+            /**
+             * \brief verifies with the cached per-key contexts
+             * \param key public key, see rsa::public_key
+             */
+            template <class InputIterator>
+            static bool verify(InputIterator s_first, InputIterator s_last, InputIterator m_first, InputIterator m_last, const public_key<Integer>& key)
+            {
+                return verify_with(s_first, s_last, m_first, m_last, key.n, key.bits(), [&](const Integer& s) { return rsaep(key, s); });
+            }
+
+            /**
+             * \brief verifies against a precomputed DigestType(M) of DigestType::size octets
+             */
+            template <class InputIterator, class HInputIterator>
+            static bool verify_digest(InputIterator s_first, InputIterator s_last, HInputIterator h_first, HInputIterator h_last, const Integer& e, const Integer& n, size_t modulusBits)
+            {
+                const std::vector<uint8_t> hash = digest_of(h_first, h_last);
+
+                return verify_digest_with(s_first, s_last, hash.data(), n, modulusBits, [&](const Integer& s) { return cry::pow_mod(s, e, n); });
+            }
+
+            template <class InputIterator, class HInputIterator>
+            static bool verify_digest(InputIterator s_first, InputIterator s_last, HInputIterator h_first, HInputIterator h_last, const public_key<Integer>& key)
+            {
+                const std::vector<uint8_t> hash = digest_of(h_first, h_last);
 
+                return verify_digest_with(s_first, s_last, hash.data(), key.n, key.bits(), [&](const Integer& s) { return rsaep(key, s); });
+            }
+
+            /**
+             * \brief verifies a batch of signatures against one key on the shared worker pool
+             * \tparam RandomIterator iterator over rsa::signed_message
+             * \param key public key, its contexts are built once and shared by all items
+             * \return bitmap, bit i is set iff item i verified
+             */
+            template <class RandomIterator>
+            static std::vector<bool> verify_batch(RandomIterator first, RandomIterator last, const public_key<Integer>& key)
+            {
+                const size_t modBits = key.bits();
+                const size_t k       = (modBits + 7) / 8;
+
+                return verify_batch_with(first, last, [&key, modBits, k](const signed_message& item) {
+                    // EM || EM', reused by every item this thread verifies
+                    thread_local std::vector<uint8_t> buffer;
+                    buffer.resize(2 * k);
+
+                    uint8_t hash[DigestType::size];
+                    DigestType()(item.message, item.message + item.message_size, hash);
+
+                    return verify_hash_with(item.signature, item.signature + item.signature_size, hash, key.n, modBits, [&key](const Integer& s) { return rsaep(key, s); }, buffer.data()) == status::ok;
+                });
+            }
+
+          private:
+            template <class HInputIterator>
+            static std::vector<uint8_t> digest_of(HInputIterator h_first, HInputIterator h_last)
+            {
+                std::vector<uint8_t> hash(h_first, h_last);
+                if (hash.size() != DigestType::size)
+                {
+                    throw std::runtime_error("digest length mismatch");
+                }
+
+                return hash;
+            }
+
+            template <class InputIterator, class Primitive>
+            static bool verify_with(InputIterator s_first, InputIterator s_last, InputIterator m_first, InputIterator m_last, const Integer& n, size_t modulusBits, Primitive primitive)
+            {
+                std::vector<uint8_t> hash(DigestType::size);
+                DigestType()(m_first, m_last, hash.begin());
+
+                return verify_digest_with(s_first, s_last, hash.data(), n, modulusBits, primitive);
+            }
+
+            template <class InputIterator, class Primitive>
+            static bool verify_digest_with(InputIterator s_first, InputIterator s_last, const uint8_t* hash, const Integer& n, size_t modulusBits, Primitive primitive)
+            {
+                std::vector<uint8_t> buffer(2 * ((modulusBits + 7) / 8));
+
+                const status result = verify_hash_with(s_first, s_last, hash, n, modulusBits, primitive, buffer.data());
+                if (result != status::ok && result != status::inconsistent)
+                {
+                    throw_on_error(result);
+                }
+
+                return result == status::ok;
+            }
+
+            /**
+             * \brief RSASSA-PKCS1-V1_5-VERIFY steps 1-4 against the hash of M, shared by every verification path
+             * \param buffer EM || EM', 2k octets
+             * \return status::ok, status::inconsistent if the signature does not verify, or the error of the EM' encoding
+             */
+            template <class InputIterator, class Primitive>
+            static status verify_hash_with(InputIterator s_first, InputIterator s_last, const uint8_t* hash, const Integer& n, size_t modulusBits, Primitive primitive, uint8_t* buffer)
+            {
                 ///////////////////////
                 // 1. Length checking:
-                const auto k = (modulusBits + 7) / 8;
-                auto sz      = std::distance(s_first, s_last);
-                if (k != sz)
+                const size_t k = (modulusBits + 7) / 8;
+                if (static_cast<size_t>(std::distance(s_first, s_last)) != k)
                 {
-                    return false;
+                    return status::inconsistent;
                 }
 
                 ////////////////////////
@@ -78,33 +198,161 @@ namespace cry
                 //////////////////////////////////////////////////////////////////////
                 // 2a. Convert the signature S to an integer signature representative
                 const Integer s = OS2IP<Integer>()(s_first, s_last);
+                if (s >= n)
+                {
+                    return status::inconsistent;
+                }
 
                 ///////////////////////////////////////////////
                 // 2b. Apply the RSAVP1 verification primitive
-                const Integer m = cry::pow_mod(s, e, n);
+                const Integer m = primitive(s);
 
                 ////////////////////////////////////////////////////////////////////////////////////////
                 // 2c. Convert the message representative m to an encoded message EM of length k octets
-                const std::vector<uint8_t> EM = I2OSP<Integer>()(m);
+                uint8_t* EM = buffer;
+                if (!I2OSP_fixed(m, EM, k))
+                {
+                    return status::inconsistent;
+                }
 
-                ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-                // 3. Apply the EMSA-PKCS1-v1_5 encoding operation to the message M to produce a second encoded message EM� of length k octets:
-                std::vector<uint8_t> EM_(k);
-                emsa_pkcs1<DigestType>::encode(m_first, m_last, EM_.begin(), k);
+                ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+                // 3. Apply the EMSA-PKCS1-v1_5 encoding to the hash of M to produce a second encoded message EM' of length k octets:
+                uint8_t* EM_         = buffer + k;
+                const status encoded = emsa_pkcs1<DigestType>::try_encode_hash(hash, EM_, k);
+                if (encoded != status::ok)
+                {
+                    return encoded;
+                }
 
                 ////////////////////////////////////////////////////////////////////////
-                // 4. Compare the encoded message EM and the second encoded message EM�
-                auto it(EM_.begin());
+                // 4. Compare the encoded message EM and the second encoded message EM'
+                return std::equal(EM, EM + k, EM_) ? status::ok : status::inconsistent;
+            }
+
+            template <class InputIterator, class OutputIterator, class Primitive>
+            static OutputIterator sign_with(InputIterator first, InputIterator last, OutputIterator result, size_t modBits, Primitive primitive)
+            {
+                std::vector<uint8_t> hash(DigestType::size);
+                DigestType()(first, last, hash.begin());
+
+                return sign_digest_with(hash.data(), result, modBits, primitive);
+            }
+
+            template <class OutputIterator, class Primitive>
+            static OutputIterator sign_digest_with(const uint8_t* hash, OutputIterator result, size_t modBits, Primitive primitive)
+            {
+                const auto emLen = (modBits + 7) / 8;
+                std::vector<uint8_t> encoded(emLen);
 
-                if (EM_.size() != EM.size())
+                ////////////////////////////////////////////////////////////////
+                // Apply the EMSA - PKCS1 - v1_5 encoding operation to the hash
+                throw_on_error(emsa_pkcs1<DigestType>::try_encode_hash(hash, encoded.data(), emLen));
+
+                const Integer arg = OS2IP<Integer>()(encoded.begin(), encoded.end());
+                const Integer s   = primitive(arg);
+
+                // S is exactly k octets, leading zeros included; EM is no longer needed, so its buffer is reused
+                if (!I2OSP_fixed(s, encoded.data(), emLen))
                 {
-                    ++it;
+                    throw std::runtime_error("signature representative out of range");
                 }
 
-                auto f = std::equal(it, std::end(EM_), std::begin(EM), std::end(EM));
+                result = std::copy(encoded.begin(), encoded.end(), result);
+
+                return result;
+            }
+        };
+
+        /**
+         * \brief signs a message fed in pieces: update() hashes as the data arrives, finish() does the RSA step
+         *
+         * Memory use does not depend on the message length. The key must outlive the signer.
+         */
+        template <class DigestType, class Integer>
+        class rsassa_pkcs1<DigestType, Integer>::signer
+        {
+          public:
+            explicit signer(const private_key<Integer>& key, crt_mode mode = crt_mode::sequential) : m_Key(key), m_Mode(mode)
+            {
+                m_Digest.Init();
+            }
+
+            template <class InputIterator>
+            signer& update(InputIterator first, InputIterator last)
+            {
+                m_Digest.Update(first, last);
+                return *this;
+            }
+
+            signer& update(const uint8_t* data, size_t size)
+            {
+                return update(data, data + size);
+            }
+
+            /**
+             * \brief writes the k-octet signature of everything passed to update() and starts a new message
+             */
+            template <class OutputIterator>
+            OutputIterator finish(OutputIterator result)
+            {
+                std::vector<uint8_t> hash(DigestType::size);
+                m_Digest.Final(hash.begin());
+                m_Digest.Init();
+
+                const private_key<Integer>& key = m_Key;
+                const crt_mode mode             = m_Mode;
+
+                return rsassa_pkcs1::sign_digest_with(hash.data(), result, key.bits(), [&key, mode](const Integer& m) { return rsadp(key, m, mode); });
+            }
+
+          private:
+            const private_key<Integer>& m_Key;
+            crt_mode m_Mode;
+            DigestType m_Digest;
+        };
+
+        /**
+         * \brief verifies a signature over a message fed in pieces, see rsassa_pkcs1::signer
+         */
+        template <class DigestType, class Integer>
+        class rsassa_pkcs1<DigestType, Integer>::verifier
+        {
+          public:
+            explicit verifier(const public_key<Integer>& key) : m_Key(key)
+            {
+                m_Digest.Init();
+            }
+
+            template <class InputIterator>
+            verifier& update(InputIterator first, InputIterator last)
+            {
+                m_Digest.Update(first, last);
+                return *this;
+            }
 
-                return f;
+            verifier& update(const uint8_t* data, size_t size)
+            {
+                return update(data, data + size);
             }
+
+            /**
+             * \brief checks the signature against everything passed to update() and starts a new message
+             */
+            template <class InputIterator>
+            bool finish(InputIterator s_first, InputIterator s_last)
+            {
+                std::vector<uint8_t> hash(DigestType::size);
+                m_Digest.Final(hash.begin());
+                m_Digest.Init();
+
+                const public_key<Integer>& key = m_Key;
+
+                return rsassa_pkcs1::verify_digest_with(s_first, s_last, hash.data(), key.n, key.bits(), [&key](const Integer& s) { return rsaep(key, s); });
+            }
+
+          private:
+            const public_key<Integer>& m_Key;
+            DigestType m_Digest;
         };
     } // namespace rsa
 
@@ -7,6 +7,8 @@
 
 #include "basic_integer.hpp"
 #include "emsa_pss.hpp"
+#include "private_key.hpp"
+#include "verify_batch.hpp"
 
 namespace cry
 {
@@ -16,6 +18,9 @@ namespace cry
         template <class Digest = sha1, class MGFType = mgf1<sha1>, size_t sLen = Digest::size, class Integer = bigint_t>
         struct rsassa_pss
         {
+            class signer;
+            class verifier;
+
             /**
              * \brief
              * \tparam InputIterator
@@ -32,29 +37,37 @@ namespace cry
             template <class InputIterator, class OutputIterator>
             static OutputIterator sign(InputIterator m_first, InputIterator m_last, OutputIterator result, const Integer& n, const Integer& d, size_t modBits, const vector<uint8_t>& salt = vector<uint8_t>())
             {
-                //////////////////////////
-                // 1. EMSA-PSS encoding:
-                std::vector<uint8_t> EM(modBits / 8);
-                emsa_pss<Digest, MGFType, sLen>::encode(m_first, m_last, EM.begin(), modBits - 1, salt);
-
-                //////////////////////////
-                // 2. RSA signature:
+                return sign_with(m_first, m_last, result, modBits, salt, [&](const Integer& m) { return cry::pow_mod(m, d, n); });
+            }
 
-                /////////////////////////////////////////////////////////////////////////////
-                // 2a. Convert the encoded message EM to an integer message representative m
-                const Integer m = OS2IP<Integer>()(EM.begin(), EM.end());
+            /**
+             * \brief signs with the CRT form of the private key
+             * \param key private key, see rsa::private_key
+             * \param mode see rsa::crt_mode
+             */
+            template <class InputIterator, class OutputIterator>
+            static OutputIterator sign(InputIterator m_first, InputIterator m_last, OutputIterator result, const private_key<Integer>& key, const vector<uint8_t>& salt = vector<uint8_t>(), crt_mode mode = crt_mode::sequential)
+            {
+                return sign_with(m_first, m_last, result, key.bits(), salt, [&](const Integer& m) { return rsadp(key, m, mode); });
+            }
 
-                ////////////////////////////////////////////
-                // 2b. Apply the RSASP1 signature primitive
-                const Integer s = cry::pow_mod(m, d, n);
+            /**
+             * \brief signs a precomputed mHash = Digest(M) of Digest::size octets, the message is not hashed again
+             */
+            template <class HInputIterator, class OutputIterator>
+            static OutputIterator sign_digest(HInputIterator h_first, HInputIterator h_last, OutputIterator result, const Integer& n, const Integer& d, size_t modBits, const vector<uint8_t>& salt = vector<uint8_t>())
+            {
+                const std::vector<uint8_t> hash = digest_of(h_first, h_last);
 
-                //////////////////////////////////////////////////////////////////////////////////
-                // 2c. Convert the signature representative s to a signature S of length k octets
-                const std::vector<uint8_t> S = I2OSP<Integer>()(s);
+                return sign_digest_with(hash.data(), result, modBits, salt, [&](const Integer& m) { return cry::pow_mod(m, d, n); });
+            }
 
-                result = std::copy(S.begin(), S.end(), result);
+            template <class HInputIterator, class OutputIterator>
+            static OutputIterator sign_digest(HInputIterator h_first, HInputIterator h_last, OutputIterator result, const private_key<Integer>& key, const vector<uint8_t>& salt = vector<uint8_t>(), crt_mode mode = crt_mode::sequential)
+            {
+                const std::vector<uint8_t> hash = digest_of(h_first, h_last);
 
-                return result;
+                return sign_digest_with(hash.data(), result, key.bits(), salt, [&](const Integer& m) { return rsadp(key, m, mode); });
             }
 
             /**
@@ -72,12 +85,116 @@ namespace cry
              */
             template <class MInputIterator, class InputIterator>
             static bool verify(MInputIterator m_first, MInputIterator m_last, InputIterator s_first, InputIterator s_last, const Integer& n, const Integer& e, size_t modBits)
+            {
+                return verify_with(m_first, m_last, s_first, s_last, n, modBits, [&](const Integer& s) { return cry::pow_mod(s, e, n); });
+            }
+
+            /**
+             * \brief verifies with the cached per-key contexts
+             * \param key public key, see rsa::public_key
+             */
+            template <class MInputIterator, class InputIterator>
+            static bool verify(MInputIterator m_first, MInputIterator m_last, InputIterator s_first, InputIterator s_last, const public_key<Integer>& key)
+            {
+                return verify_with(m_first, m_last, s_first, s_last, key.n, key.bits(), [&](const Integer& s) { return rsaep(key, s); });
+            }
+
+            /**
+             * \brief verifies against a precomputed mHash = Digest(M) of Digest::size octets
+             */
+            template <class HInputIterator, class InputIterator>
+            static bool verify_digest(HInputIterator h_first, HInputIterator h_last, InputIterator s_first, InputIterator s_last, const Integer& n, const Integer& e, size_t modBits)
+            {
+                const std::vector<uint8_t> hash = digest_of(h_first, h_last);
+
+                return verify_digest_with(hash.data(), s_first, s_last, n, modBits, [&](const Integer& s) { return cry::pow_mod(s, e, n); });
+            }
+
+            template <class HInputIterator, class InputIterator>
+            static bool verify_digest(HInputIterator h_first, HInputIterator h_last, InputIterator s_first, InputIterator s_last, const public_key<Integer>& key)
+            {
+                const std::vector<uint8_t> hash = digest_of(h_first, h_last);
+
+                return verify_digest_with(hash.data(), s_first, s_last, key.n, key.bits(), [&](const Integer& s) { return rsaep(key, s); });
+            }
+
+            /**
+             * \brief verifies a batch of signatures against one key on the shared worker pool
+             * \tparam RandomIterator iterator over rsa::signed_message
+             * \param key public key, its contexts are built once and shared by all items
+             * \return bitmap, bit i is set iff item i verified
+             */
+            template <class RandomIterator>
+            static std::vector<bool> verify_batch(RandomIterator first, RandomIterator last, const public_key<Integer>& key)
+            {
+                const size_t modBits = key.bits();
+                const size_t emLen   = (modBits + 6) / 8;
+
+                return verify_batch_with(first, last, [&key, modBits, emLen](const signed_message& item) {
+                    // EM || workspace, reused by every item this thread verifies
+                    thread_local std::vector<uint8_t> buffer;
+                    buffer.resize(emLen + emsa_pss<Digest, MGFType, sLen>::workspace_size(emLen));
+
+                    uint8_t mHash[Digest::size];
+                    Digest()(item.message, item.message + item.message_size, mHash);
+
+                    return verify_hash_with(mHash, item.signature, item.signature + item.signature_size, key.n, modBits, [&key](const Integer& s) { return rsaep(key, s); }, buffer.data()) == status::ok;
+                });
+            }
+
+          private:
+            template <class HInputIterator>
+            static std::vector<uint8_t> digest_of(HInputIterator h_first, HInputIterator h_last)
+            {
+                std::vector<uint8_t> hash(h_first, h_last);
+                if (hash.size() != Digest::size)
+                {
+                    throw std::runtime_error("digest length mismatch");
+                }
+
+                return hash;
+            }
+
+            template <class MInputIterator, class InputIterator, class Primitive>
+            static bool verify_with(MInputIterator m_first, MInputIterator m_last, InputIterator s_first, InputIterator s_last, const Integer& n, size_t modBits, Primitive primitive)
+            {
+                std::vector<uint8_t> mHash(Digest::size);
+                Digest()(m_first, m_last, mHash.begin());
+
+                return verify_digest_with(mHash.data(), s_first, s_last, n, modBits, primitive);
+            }
+
+            template <class InputIterator, class Primitive>
+            static bool verify_digest_with(const uint8_t* mHash, InputIterator s_first, InputIterator s_last, const Integer& n, size_t modBits, Primitive primitive)
+            {
+                const size_t emLen = (modBits + 6) / 8;
+
+                std::vector<uint8_t> buffer(emLen + emsa_pss<Digest, MGFType, sLen>::workspace_size(emLen));
+
+                const status result = verify_hash_with(mHash, s_first, s_last, n, modBits, primitive, buffer.data());
+                if (result == status::internal_error)
+                {
+                    throw_on_error(result);
+                }
+
+                return result == status::ok;
+            }
+
+            /**
+             * \brief RSASSA-PSS-VERIFY steps 1-3 against mHash, shared by every verification path
+             * \param buffer EM || workspace, emLen + workspace_size(emLen) octets with emLen = ceil((modBits - 1) / 8)
+             * \return status::ok, status::inconsistent if the signature does not verify, status::internal_error
+             */
+            template <class InputIterator, class Primitive>
+            static status verify_hash_with(const uint8_t* mHash, InputIterator s_first, InputIterator s_last, const Integer& n, size_t modBits, Primitive primitive, uint8_t* buffer)
             {
                 //////////////////////////////////////////
-                // 1. Length checking:
-                auto k = std::distance(s_first, s_last);
-                if (k != modBits / 8)
-                    return false;
+                // 1. Length checking: S has k = ceil(modBits / 8) octets
+                const size_t k = static_cast<size_t>(std::distance(s_first, s_last));
+                if (k != (modBits + 7) / 8)
+                {
+                    return status::inconsistent;
+                }
 
                 ///////////////////////////////////////
                 // 2. RSA verification:
@@ -85,22 +202,173 @@ namespace cry
                 ///////////////////////////////////////////////////////////////////////
                 // 2a. Convert the signature S to an integer signature representative s
                 const Integer s = OS2IP<Integer>()(s_first, s_last);
+                if (s >= n)
+                {
+                    return status::inconsistent;
+                }
 
                 ///////////////////////////////////////////////////////////////////////
                 // 2b. Apply the RSAVP1 verification primitive to to produce an integer message representative m:
-                const Integer m = cry::pow_mod(s, e, n);
+                const Integer m = primitive(s);
 
                 ///////////////////////////////////////////////////////////////////////
-                // 2c. Convert the message representative m to an encoded message EM
-                const std::vector<uint8_t> EM = I2OSP<Integer>()(m);
+                // 2c. Convert the message representative m to an encoded message EM of emLen octets
+                const size_t emLen = (modBits + 6) / 8;
+
+                if (!I2OSP_fixed(m, buffer, emLen))
+                {
+                    return status::inconsistent;
+                }
 
                 //////////////////////////////
                 // 3. EMSA - PSS verification
-                const bool result = emsa_pss<Digest, MGFType, sLen>::verify(m_first, m_last, EM.begin(), EM.end(), modBits - 1);
+                return emsa_pss<Digest, MGFType, sLen>::try_verify_hash(mHash, buffer, emLen, modBits - 1, buffer + emLen);
+            }
+
+            template <class InputIterator, class OutputIterator, class Primitive>
+            static OutputIterator sign_with(InputIterator m_first, InputIterator m_last, OutputIterator result, size_t modBits, const vector<uint8_t>& salt, Primitive primitive)
+            {
+                std::vector<uint8_t> mHash(Digest::size);
+                Digest()(m_first, m_last, mHash.begin());
+
+                return sign_digest_with(mHash.data(), result, modBits, salt, primitive);
+            }
+
+            template <class OutputIterator, class Primitive>
+            static OutputIterator sign_digest_with(const uint8_t* mHash, OutputIterator result, size_t modBits, const vector<uint8_t>& salt, Primitive primitive)
+            {
+                //////////////////////////
+                // 1. EMSA-PSS encoding:
+                if (!salt.empty() && salt.size() != sLen)
+                {
+                    throw_on_error(status::encoding_error);
+                }
+
+                // EM || workspace in one allocation
+                const size_t emLen = (modBits + 6) / 8;
+
+                std::vector<uint8_t> buffer(emLen + emsa_pss<Digest, MGFType, sLen>::workspace_size(emLen));
+                const auto EM = buffer.begin();
+
+                throw_on_error(emsa_pss<Digest, MGFType, sLen>::try_encode_hash(mHash, buffer.data(), emLen, modBits - 1, salt.empty() ? nullptr : salt.data(), buffer.data() + emLen));
+
+                //////////////////////////
+                // 2. RSA signature:
+
+                /////////////////////////////////////////////////////////////////////////////
+                // 2a. Convert the encoded message EM to an integer message representative m
+                const Integer m = OS2IP<Integer>()(EM, EM + emLen);
+
+                ////////////////////////////////////////////
+                // 2b. Apply the RSASP1 signature primitive
+                const Integer s = primitive(m);
+
+                //////////////////////////////////////////////////////////////////////////////////
+                // 2c. Convert the signature representative s to a signature S of length k octets
+                std::vector<uint8_t> S((modBits + 7) / 8);
+                if (!I2OSP_fixed(s, S.data(), S.size()))
+                {
+                    throw std::runtime_error("signature representative out of range");
+                }
+
+                result = std::copy(S.begin(), S.end(), result);
 
                 return result;
             }
         };
+
+        /**
+         * \brief signs a message fed in pieces: update() hashes as the data arrives, finish() encodes mHash and does the RSA step
+         *
+         * Memory use does not depend on the message length. The key must outlive the signer.
+         */
+        template <class Digest, class MGFType, size_t sLen, class Integer>
+        class rsassa_pss<Digest, MGFType, sLen, Integer>::signer
+        {
+          public:
+            explicit signer(const private_key<Integer>& key, crt_mode mode = crt_mode::sequential) : m_Key(key), m_Mode(mode)
+            {
+                m_Digest.Init();
+            }
+
+            template <class InputIterator>
+            signer& update(InputIterator first, InputIterator last)
+            {
+                m_Digest.Update(first, last);
+                return *this;
+            }
+
+            signer& update(const uint8_t* data, size_t size)
+            {
+                return update(data, data + size);
+            }
+
+            /**
+             * \brief writes the signature of everything passed to update() and starts a new message
+             * \param salt empty - a random salt of sLen octets
+             */
+            template <class OutputIterator>
+            OutputIterator finish(OutputIterator result, const vector<uint8_t>& salt = vector<uint8_t>())
+            {
+                std::vector<uint8_t> mHash(Digest::size);
+                m_Digest.Final(mHash.begin());
+                m_Digest.Init();
+
+                const private_key<Integer>& key = m_Key;
+                const crt_mode mode             = m_Mode;
+
+                return rsassa_pss::sign_digest_with(mHash.data(), result, key.bits(), salt, [&key, mode](const Integer& m) { return rsadp(key, m, mode); });
+            }
+
+          private:
+            const private_key<Integer>& m_Key;
+            crt_mode m_Mode;
+            Digest m_Digest;
+        };
+
+        /**
+         * \brief verifies a signature over a message fed in pieces, see rsassa_pss::signer
+         */
+        template <class Digest, class MGFType, size_t sLen, class Integer>
+        class rsassa_pss<Digest, MGFType, sLen, Integer>::verifier
+        {
+          public:
+            explicit verifier(const public_key<Integer>& key) : m_Key(key)
+            {
+                m_Digest.Init();
+            }
+
+            template <class InputIterator>
+            verifier& update(InputIterator first, InputIterator last)
+            {
+                m_Digest.Update(first, last);
+                return *this;
+            }
+
+            verifier& update(const uint8_t* data, size_t size)
+            {
+                return update(data, data + size);
+            }
+
+            /**
+             * \brief checks the signature against everything passed to update() and starts a new message
+             */
+            template <class InputIterator>
+            bool finish(InputIterator s_first, InputIterator s_last)
+            {
+                std::vector<uint8_t> mHash(Digest::size);
+                m_Digest.Final(mHash.begin());
+                m_Digest.Init();
+
+                const public_key<Integer>& key = m_Key;
+
+                return rsassa_pss::verify_digest_with(mHash.data(), s_first, s_last, key.n, key.bits(), [&key](const Integer& s) { return rsaep(key, s); });
+            }
+
+          private:
+            const public_key<Integer>& m_Key;
+            Digest m_Digest;
+        };
     } // namespace rsa
 } // namespace cry
 
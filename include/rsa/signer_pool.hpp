@@ -0,0 +1,278 @@
+#ifndef RSA_SIGNER_POOL_HPP
+#define RSA_SIGNER_POOL_HPP
+
+#include "private_key.hpp"
+#include "rsassa_pkcs1.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace cry
+{
+    namespace rsa
+    {
+        /**
+         * \brief signs queued messages or digests with one private key on a set of workers that steal from each other
+         *
+         * Every worker owns a deque: submissions are spread over the deques round-robin, a worker takes
+         * from the front of its own deque and, once that is empty, from the back of another worker's.
+         * \tparam Scheme signature scheme with sign and sign_digest(first, last, result, private_key), rsassa_pkcs1 or rsassa_pss
+         * \tparam Integer integer type
+         */
+        template <class Scheme = rsassa_pkcs1<>, class Integer = bigint_t>
+        class signer_pool
+        {
+          public:
+            using signature_type = std::vector<uint8_t>;
+
+            /**
+             * \param key private key, copied into the pool
+             * \param nthreads number of workers, 0 - one per hardware thread
+             */
+            explicit signer_pool(private_key<Integer> key, size_t nthreads = 0) : m_Key(std::move(key))
+            {
+                if (nthreads == 0)
+                {
+                    nthreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+                }
+
+                m_Queues.reserve(nthreads);
+                for (size_t i = 0; i != nthreads; ++i)
+                {
+                    m_Queues.emplace_back(new queue_type);
+                }
+
+                // build the per-key contexts before the workers race for them
+                m_Key.size();
+
+                m_Threads.reserve(nthreads);
+                for (size_t i = 0; i != nthreads; ++i)
+                {
+                    m_Threads.emplace_back([this, i] { run(i); });
+                }
+            }
+
+            signer_pool(const signer_pool&) = delete;
+            signer_pool& operator=(const signer_pool&) = delete;
+
+            /**
+             * \brief signs everything still queued, then stops the workers
+             */
+            ~signer_pool()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_Mutex);
+                    m_Stop = true;
+                }
+
+                m_Ready.notify_all();
+
+                for (auto& thread : m_Threads)
+                {
+                    thread.join();
+                }
+            }
+
+            size_t size() const noexcept
+            {
+                return m_Threads.size();
+            }
+
+            /**
+             * \brief queues a message
+             * \return future signature, or the exception the scheme threw
+             */
+            std::future<signature_type> sign(std::vector<uint8_t> message)
+            {
+                auto promise = std::make_shared<std::promise<signature_type>>();
+                auto future  = promise->get_future();
+
+                sign(std::move(message), fulfil(promise));
+
+                return future;
+            }
+
+            /**
+             * \brief queues a message, callback(error, signature) runs on the worker that signed it and must not throw
+             */
+            template <class Callback>
+            void sign(std::vector<uint8_t> message, Callback callback)
+            {
+                enqueue(std::move(message), callback, [](const private_key<Integer>& key, const std::vector<uint8_t>& input, signature_type& signature) {
+                    Scheme::sign(input.begin(), input.end(), signature.begin(), key);
+                });
+            }
+
+            /**
+             * \brief queues a digest computed by the caller, signed with Scheme::sign_digest
+             * \return future signature, or the exception the scheme threw, e.g. for a digest of the wrong length
+             */
+            std::future<signature_type> sign_digest(std::vector<uint8_t> digest)
+            {
+                auto promise = std::make_shared<std::promise<signature_type>>();
+                auto future  = promise->get_future();
+
+                sign_digest(std::move(digest), fulfil(promise));
+
+                return future;
+            }
+
+            /**
+             * \brief queues a digest, see sign(message, callback)
+             */
+            template <class Callback>
+            void sign_digest(std::vector<uint8_t> digest, Callback callback)
+            {
+                enqueue(std::move(digest), callback, [](const private_key<Integer>& key, const std::vector<uint8_t>& input, signature_type& signature) {
+                    Scheme::sign_digest(input.begin(), input.end(), signature.begin(), key);
+                });
+            }
+
+          private:
+            using task_type = std::function<void()>;
+
+            struct queue_type
+            {
+                std::mutex mutex;
+                std::deque<task_type> tasks;
+            };
+
+            static auto fulfil(std::shared_ptr<std::promise<signature_type>> promise)
+            {
+                return [promise](std::exception_ptr error, signature_type signature) {
+                    if (error)
+                    {
+                        promise->set_exception(error);
+                    }
+                    else
+                    {
+                        promise->set_value(std::move(signature));
+                    }
+                };
+            }
+
+            template <class Callback, class Sign>
+            void enqueue(std::vector<uint8_t> input, Callback callback, Sign sign)
+            {
+                push([this, input = std::move(input), callback, sign]() mutable {
+                    signature_type signature(m_Key.size());
+                    std::exception_ptr error;
+
+                    try
+                    {
+                        sign(m_Key, input, signature);
+                    }
+                    catch (...)
+                    {
+                        error = std::current_exception();
+                        signature.clear();
+                    }
+
+                    callback(error, std::move(signature));
+                });
+            }
+
+            void push(task_type task)
+            {
+                {
+                    // counted first, so a worker never takes a task that is not counted yet
+                    std::lock_guard<std::mutex> lock(m_Mutex);
+                    ++m_Queued;
+                }
+
+                queue_type& queue = *m_Queues[m_Next.fetch_add(1) % m_Queues.size()];
+                {
+                    std::lock_guard<std::mutex> lock(queue.mutex);
+                    queue.tasks.push_back(std::move(task));
+                }
+
+                m_Ready.notify_one();
+            }
+
+            bool pop(size_t self, task_type& task)
+            {
+                ////////////////////////////
+                // 1. own deque, oldest first
+                {
+                    queue_type& queue = *m_Queues[self];
+
+                    std::lock_guard<std::mutex> lock(queue.mutex);
+                    if (!queue.tasks.empty())
+                    {
+                        task = std::move(queue.tasks.front());
+                        queue.tasks.pop_front();
+                        return true;
+                    }
+                }
+
+                ////////////////////////////////////////////
+                // 2. steal the newest task of another worker
+                for (size_t i = 1; i != m_Queues.size(); ++i)
+                {
+                    queue_type& victim = *m_Queues[(self + i) % m_Queues.size()];
+
+                    std::lock_guard<std::mutex> lock(victim.mutex);
+                    if (!victim.tasks.empty())
+                    {
+                        task = std::move(victim.tasks.back());
+                        victim.tasks.pop_back();
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+
+            void run(size_t self)
+            {
+                for (;;)
+                {
+                    task_type task;
+                    if (pop(self, task))
+                    {
+                        {
+                            std::lock_guard<std::mutex> lock(m_Mutex);
+                            --m_Queued;
+                        }
+
+                        task();
+                        continue;
+                    }
+
+                    std::unique_lock<std::mutex> lock(m_Mutex);
+                    if (m_Stop && m_Queued == 0)
+                    {
+                        return;
+                    }
+
+                    // a task counted but not pushed yet keeps the predicate true until it lands in a deque
+                    m_Ready.wait(lock, [this] { return m_Stop || m_Queued > 0; });
+                }
+            }
+
+          private:
+            private_key<Integer> m_Key;
+
+            std::vector<std::unique_ptr<queue_type>> m_Queues;
+            std::atomic<size_t> m_Next{ 0 };
+
+            std::mutex m_Mutex;
+            std::condition_variable m_Ready;
+            size_t m_Queued = 0;
+            bool m_Stop     = false;
+
+            std::vector<std::thread> m_Threads;
+        };
+    } // namespace rsa
+} // namespace cry
+
+#endif // RSA_SIGNER_POOL_HPP
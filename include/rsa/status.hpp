@@ -0,0 +1,60 @@
+#ifndef RSA_STATUS_HPP
+#define RSA_STATUS_HPP
+
+#include <stdexcept>
+
+namespace cry
+{
+    namespace rsa
+    {
+        /**
+         * \brief outcome of the non-throwing try_* operations
+         */
+        enum class status
+        {
+            ok,
+            decryption_error, // every decryption failure, deliberately not told apart (RFC 8017, 7.1.2 note)
+            encoding_error,
+            message_too_long,
+            inconsistent,     // the signature does not verify
+            buffer_too_small, // the caller's output buffer cannot hold the result
+            internal_error    // the arithmetic underneath threw, e.g. out of memory
+        };
+
+        inline const char* to_string(status s) noexcept
+        {
+            switch (s)
+            {
+            case status::ok:
+                return "ok";
+            case status::decryption_error:
+                return "decryption error";
+            case status::encoding_error:
+                return "encoding error";
+            case status::message_too_long:
+                return "message too long";
+            case status::inconsistent:
+                return "inconsistent";
+            case status::buffer_too_small:
+                return "output buffer too small";
+            case status::internal_error:
+                break;
+            }
+
+            return "internal error";
+        }
+
+        /**
+         * \brief the throwing API on top of the try_* one: anything but status::ok becomes std::runtime_error
+         */
+        inline void throw_on_error(status s)
+        {
+            if (s != status::ok)
+            {
+                throw std::runtime_error(to_string(s));
+            }
+        }
+    } // namespace rsa
+} // namespace cry
+
+#endif // RSA_STATUS_HPP
@@ -0,0 +1,77 @@
+#ifndef RSA_VERIFY_BATCH_HPP
+#define RSA_VERIFY_BATCH_HPP
+
+#include "basic_integer.hpp"
+#include "utility/os2ip.hpp"
+#include "utility/worker_pool.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <vector>
+
+namespace cry
+{
+    namespace rsa
+    {
+        /**
+         * \brief one entry of a batch: views of a message and of its signature, the bytes are owned by the caller
+         */
+        struct signed_message
+        {
+            const uint8_t* message;
+            size_t message_size;
+            const uint8_t* signature;
+            size_t signature_size;
+        };
+
+        /**
+         * \brief runs verify_one over [first, last) on worker_pool::shared(), 64 items per task
+         * \return bitmap, bit i is set iff item i verified; an item whose check throws counts as not verified
+         */
+        template <class RandomIterator, class Verify>
+        std::vector<bool> verify_batch_with(RandomIterator first, RandomIterator last, Verify verify_one)
+        {
+            const size_t count   = static_cast<size_t>(std::distance(first, last));
+            const size_t nblocks = (count + 63) / 64;
+
+            // one word per task, so no two tasks write into the same word
+            std::vector<uint64_t> words(nblocks);
+
+            worker_pool::shared().parallel_for(nblocks, [&](size_t block) {
+                const size_t begin = block * 64;
+                const size_t end   = std::min(begin + 64, count);
+
+                uint64_t word = 0;
+                for (size_t i = begin; i != end; ++i)
+                {
+                    bool ok;
+                    try
+                    {
+                        ok = verify_one(first[i]);
+                    }
+                    catch (const std::exception&)
+                    {
+                        ok = false;
+                    }
+
+                    word |= static_cast<uint64_t>(ok) << (i - begin);
+                }
+
+                words[block] = word;
+            });
+
+            std::vector<bool> result(count);
+            for (size_t i = 0; i != count; ++i)
+            {
+                result[i] = ((words[i / 64] >> (i % 64)) & 0x01) == 0x01;
+            }
+
+            return result;
+        }
+    } // namespace rsa
+} // namespace cry
+
+#endif // RSA_VERIFY_BATCH_HPP
@@ -3,6 +3,8 @@
 
 #include "basic_integer.hpp"
 
+#include <algorithm>
+
 namespace cry
 {
 
@@ -53,7 +55,7 @@ namespace cry
                 ++nwords;
             }
 
-            std::vector<P> dst(nwords);
+            typename cry::basic_integer<P>::polynomial_type dst(nwords);
             auto result = dst.rbegin();
 
             P word(0);
@@ -75,7 +77,7 @@ namespace cry
                 *result++ = word;
             }
 
-            cry::basic_integer<P> out(dst);
+            cry::basic_integer<P> out(std::move(dst));
 
             return out;
         }
@@ -171,6 +173,37 @@ namespace cry
         }
     };
 
+    /**
+     * \brief writes x into exactly len octets, big-endian
+     * \return returns "FALSE" if x does not fit
+     */
+    template <class P>
+    bool I2OSP_fixed(const basic_integer<P>& x, uint8_t* first, size_t len) noexcept
+    {
+        const auto& polynomial = x.polynomial();
+
+        uint8_t* out = first + len;
+        for (auto it = polynomial.rbegin(); it != polynomial.rend(); ++it)
+        {
+            P word = *it;
+            for (size_t i = 0; i != sizeof(P); ++i, word = static_cast<P>(word >> 4 >> 4))
+            {
+                if (out != first)
+                {
+                    *--out = static_cast<uint8_t>(word & 0xFF);
+                }
+                else if ((word & 0xFF) != 0x00)
+                {
+                    return false;
+                }
+            }
+        }
+
+        std::fill(first, out, 0x00);
+
+        return true;
+    }
+
 } // namespace cry
 
 #endif
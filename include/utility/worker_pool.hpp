@@ -0,0 +1,260 @@
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace cry
+{
+    /**
+     * \brief fixed set of threads draining a shared FIFO of tasks, started once and reused for every call
+     */
+    class worker_pool
+    {
+      public:
+        using task_type = std::function<void()>;
+
+        explicit worker_pool(size_t nthreads)
+        {
+            nthreads = std::max<size_t>(nthreads, 1);
+
+            m_Threads.reserve(nthreads);
+            for (size_t i = 0; i != nthreads; ++i)
+            {
+                m_Threads.emplace_back([this] { run(); });
+            }
+        }
+
+        worker_pool(const worker_pool&) = delete;
+        worker_pool& operator=(const worker_pool&) = delete;
+
+        ~worker_pool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Stop = true;
+            }
+
+            m_Ready.notify_all();
+
+            for (auto& thread : m_Threads)
+            {
+                thread.join();
+            }
+        }
+
+        /**
+         * \brief process-wide pool, one thread less than the hardware reports (the caller is the other one)
+         */
+        static worker_pool& shared()
+        {
+            static worker_pool pool(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 1);
+            return pool;
+        }
+
+        size_t size() const noexcept
+        {
+            return m_Threads.size();
+        }
+
+        /**
+         * \brief queues the task, exceptions thrown by it are the task's own business
+         */
+        void submit(task_type task)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Tasks.push_back(std::move(task));
+            }
+
+            m_Ready.notify_one();
+        }
+
+        /**
+         * \brief runs first on the calling thread and second on the pool, returns when both are done
+         *
+         * If no worker has picked second up by the time first finishes, the caller runs it itself,
+         * so nested calls from inside the pool cannot deadlock. The first exception is rethrown.
+         */
+        template <class First, class Second>
+        void invoke(First&& first, Second&& second)
+        {
+            struct state_type
+            {
+                std::atomic<bool> claimed{ false };
+                std::mutex mutex;
+                std::condition_variable done_cv;
+                bool done = false;
+                std::exception_ptr error;
+            };
+
+            auto state = std::make_shared<state_type>();
+            auto task  = &second;
+
+            submit([state, task] {
+                if (state->claimed.exchange(true))
+                {
+                    return;
+                }
+
+                try
+                {
+                    (*task)();
+                }
+                catch (...)
+                {
+                    state->error = std::current_exception();
+                }
+
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->done = true;
+                state->done_cv.notify_one();
+            });
+
+            std::exception_ptr error;
+            try
+            {
+                first();
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+
+            if (!state->claimed.exchange(true))
+            {
+                if (!error)
+                {
+                    second();
+                }
+            }
+            else
+            {
+                std::unique_lock<std::mutex> lock(state->mutex);
+                state->done_cv.wait(lock, [&] { return state->done; });
+
+                if (!error)
+                {
+                    error = state->error;
+                }
+            }
+
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+
+        /**
+         * \brief calls f(i) for every i in [0, count) on the pool and the calling thread, returns when all calls are done
+         *
+         * Indices are handed out one at a time, the caller takes part, so it works from inside the pool as well.
+         * The first exception is rethrown once the remaining indices have run.
+         */
+        template <class Function>
+        void parallel_for(size_t count, Function&& f)
+        {
+            struct state_type
+            {
+                std::atomic<size_t> next{ 0 };
+                std::atomic<size_t> finished{ 0 };
+                size_t count;
+                std::mutex mutex;
+                std::condition_variable done_cv;
+                std::exception_ptr error;
+            };
+
+            if (count == 0)
+            {
+                return;
+            }
+
+            auto state   = std::make_shared<state_type>();
+            state->count = count;
+
+            auto function = &f;
+
+            auto drain = [state, function] {
+                for (size_t i; (i = state->next.fetch_add(1)) < state->count;)
+                {
+                    try
+                    {
+                        (*function)(i);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(state->mutex);
+                        if (!state->error)
+                        {
+                            state->error = std::current_exception();
+                        }
+                    }
+
+                    if (state->finished.fetch_add(1) + 1 == state->count)
+                    {
+                        std::lock_guard<std::mutex> lock(state->mutex);
+                        state->done_cv.notify_all();
+                    }
+                }
+            };
+
+            const size_t helpers = std::min(size(), count - 1);
+            for (size_t i = 0; i != helpers; ++i)
+            {
+                submit(drain);
+            }
+
+            drain();
+
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->done_cv.wait(lock, [&] { return state->finished.load() == state->count; });
+
+            if (state->error)
+            {
+                std::rethrow_exception(state->error);
+            }
+        }
+
+      private:
+        void run()
+        {
+            for (;;)
+            {
+                task_type task;
+
+                {
+                    std::unique_lock<std::mutex> lock(m_Mutex);
+                    m_Ready.wait(lock, [this] { return m_Stop || !m_Tasks.empty(); });
+
+                    if (m_Tasks.empty())
+                    {
+                        return;
+                    }
+
+                    task = std::move(m_Tasks.front());
+                    m_Tasks.pop_front();
+                }
+
+                task();
+            }
+        }
+
+      private:
+        std::mutex m_Mutex;
+        std::condition_variable m_Ready;
+        std::deque<task_type> m_Tasks;
+        bool m_Stop = false;
+        std::vector<std::thread> m_Threads;
+    };
+} // namespace cry
+
+#endif // WORKER_POOL_HPP